@@ -0,0 +1,1105 @@
+/***********************************************************************
+ * Program:
+ *    BENCH DEQUE
+ * Summary:
+ *    Micro-benchmarks for deque.h. Each benchmark prints its name and
+ *    the average time per operation. Pass a word to run only the
+ *    benchmarks whose names contain it.
+ *       g++ -std=c++17 -O2 -pthread benchDeque.cpp -o benchDeque
+ *       ./benchDeque [filter]
+ * Author
+ *    Marco Varela & Andre Regino
+ ************************************************************************/
+
+#include "deque.h"     // class under test
+#include "budget.h"    // for custom::deque_budget
+#include "geometric.h" // for custom::geometric_deque
+#include "parallel.h"  // for custom::parallel_copy, custom::parallel_clear
+#include "queue.h"     // for custom::queue
+#include "stack.h"     // for custom::stack
+#include "reclaimer.h" // for custom::deque_reclaimer
+
+#include <algorithm>   // for std::remove_if, std::shuffle
+#include <cassert>     // for assert
+#include <chrono>      // for std::chrono::steady_clock
+#include <cstdio>      // for printf, snprintf
+#include <cstring>     // for strstr
+#include <deque>       // for std::deque, the baseline
+#include <memory>      // for std::unique_ptr
+#include <queue>       // for std::queue, the baseline
+#include <random>      // for std::mt19937
+#include <stack>       // for std::stack, the baseline
+#include <string>      // for std::string
+#include <thread>      // for std::thread::hardware_concurrency
+#include <vector>      // for std::vector
+#if defined(__GLIBC__)
+#include <malloc.h>    // for mallinfo2, malloc_usable_size
+#endif
+
+namespace
+{
+
+/*************************************************************
+ * SINK
+ * Keep the optimizer from discarding a benchmark's result
+ *************************************************************/
+volatile long long sink;
+
+/*************************************************************
+ * TIMER
+ * Wall-clock seconds since construction
+ *************************************************************/
+class Timer
+{
+public:
+   Timer() : start(std::chrono::steady_clock::now()) {}
+   double seconds() const
+   {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   }
+private:
+   std::chrono::steady_clock::time_point start;
+};
+
+/*************************************************************
+ * REPORT
+ * One line per benchmark: name and nanoseconds per operation
+ *************************************************************/
+void report(const char * name, long long numOps, double seconds)
+{
+   printf("%-40s %12.2f ns/op\n", name, seconds * 1e9 / (double)numOps);
+}
+
+/*************************************************************
+ * HANDLE / RELOCATABLE HANDLE
+ * The same unique_ptr holder, once as the compiler sees it
+ * and once opted in to relocation
+ *************************************************************/
+struct Handle
+{
+   Handle(int value = 0) : p(new int(value)) {}
+   std::unique_ptr<int> p;
+};
+
+struct RelocatableHandle
+{
+   RelocatableHandle(int value = 0) : p(new int(value)) {}
+   std::unique_ptr<int> p;
+};
+
+const int SHIFT_SIZE = 1 << 16;
+const int SHIFT_OPS  = 4096;
+
+/*************************************************************
+ * INSERT/ERASE MIDDLE
+ * Shift half the deque per operation
+ *************************************************************/
+template <typename T>
+void benchShiftMiddle(const char * nameInsert, const char * nameErase)
+{
+   custom::deque<T> d;
+   for (int i = 0; i < SHIFT_SIZE; i++)
+      d.push_back(T(i));
+
+   Timer timerInsert;
+   for (int i = 0; i < SHIFT_OPS; i++)
+      d.insert(typename custom::deque<T>::iterator((int)d.size() / 2 + (i & 1), &d), T(i));
+   report(nameInsert, SHIFT_OPS, timerInsert.seconds());
+
+   Timer timerErase;
+   for (int i = 0; i < SHIFT_OPS; i++)
+      d.erase(typename custom::deque<T>::iterator((int)d.size() / 2 - (i & 1), &d));
+   report(nameErase, SHIFT_OPS, timerErase.seconds());
+
+   sink = (long long)d.size();
+}
+
+void benchShiftInt()
+{
+   benchShiftMiddle<int>("insert_middle int (memmove)",
+                         "erase_middle int (memmove)");
+}
+
+void benchShiftHandle()
+{
+   benchShiftMiddle<Handle>("insert_middle unique_ptr (move)",
+                            "erase_middle unique_ptr (move)");
+}
+
+void benchShiftRelocatableHandle()
+{
+   benchShiftMiddle<RelocatableHandle>("insert_middle unique_ptr (memmove)",
+                                       "erase_middle unique_ptr (memmove)");
+}
+
+const int GATHER_SIZE  = 1 << 22;
+const int GATHER_OPS   = 1 << 22;
+const int GATHER_BATCH = 256;
+
+/*************************************************************
+ * GATHER
+ * Read random positions one at a time with operator[] and
+ * in batches with gather, unsorted and sorted by block
+ *************************************************************/
+void benchGather()
+{
+   custom::deque<int> d;
+   for (int i = 0; i < GATHER_SIZE; i++)
+      d.push_front(i);
+
+   std::mt19937 gen(5489u);
+   std::vector<int> ids(GATHER_OPS);
+   for (int & id : ids)
+      id = (int)(gen() % GATHER_SIZE);
+   std::vector<int> out(GATHER_BATCH);
+
+   long long sum = 0;
+   Timer timerIndex;
+   for (int i = 0; i < GATHER_OPS; i++)
+      sum += d[ids[i]];
+   report("random_read operator[]", GATHER_OPS, timerIndex.seconds());
+
+   Timer timerGather;
+   for (int i = 0; i < GATHER_OPS; i += GATHER_BATCH)
+   {
+      d.gather(&ids[i], GATHER_BATCH, out.data());
+      sum += out[0];
+   }
+   report("random_read gather", GATHER_OPS, timerGather.seconds());
+
+   Timer timerSorted;
+   for (int i = 0; i < GATHER_OPS; i += GATHER_BATCH)
+   {
+      d.gather(&ids[i], GATHER_BATCH, out.data(), true /*sortByBlock*/);
+      sum += out[0];
+   }
+   report("random_read gather (sorted)", GATHER_OPS, timerSorted.seconds());
+
+   sink = sum;
+}
+
+const int DRAIN_SIZE  = 1 << 22;
+const int DRAIN_BATCH = 1024;
+
+/*************************************************************
+ * DRAIN
+ * Empty the deque from the front in batches, one element at
+ * a time with front and pop_front and with pop_front_into
+ *************************************************************/
+void benchDrain()
+{
+   std::vector<int> out(DRAIN_BATCH);
+   long long sum = 0;
+
+   custom::deque<int> d;
+   for (int i = 0; i < DRAIN_SIZE; i++)
+      d.push_back(i);
+   Timer timerPop;
+   while (!d.empty())
+   {
+      for (int i = 0; i < DRAIN_BATCH; i++)
+      {
+         out[i] = d.front();
+         d.pop_front();
+      }
+      sum += out[0];
+   }
+   report("drain_front front+pop_front", DRAIN_SIZE, timerPop.seconds());
+
+   for (int i = 0; i < DRAIN_SIZE; i++)
+      d.push_back(i);
+   Timer timerInto;
+   while (!d.empty())
+      sum += out[d.pop_front_into(out.data(), DRAIN_BATCH) - 1];
+   report("drain_front pop_front_into", DRAIN_SIZE, timerInto.seconds());
+
+   sink = sum;
+}
+
+const int REBALANCE_SIZE = 1 << 22;
+
+/*************************************************************
+ * REBALANCE
+ * Hand half of a large queue to an idle worker, element by
+ * element and with splice_back
+ *************************************************************/
+void benchRebalance()
+{
+   custom::deque<int> d;
+   for (int i = 0; i < REBALANCE_SIZE; i++)
+      d.push_back(i);
+
+   custom::deque<int> dLoop;
+   Timer timerLoop;
+   for (int i = 0; i < REBALANCE_SIZE / 2; i++)
+   {
+      dLoop.push_back(d.front());
+      d.pop_front();
+   }
+   report("rebalance push_back+pop_front", REBALANCE_SIZE / 2, timerLoop.seconds());
+
+   custom::deque<int> dSplice;
+   Timer timerSplice;
+   dSplice.splice_back(dLoop, REBALANCE_SIZE / 2);
+   report("rebalance splice_back", REBALANCE_SIZE / 2, timerSplice.seconds());
+
+   sink = (long long)(d.size() + dSplice.size());
+}
+
+const int MERGE_PARTS = 8;
+const int MERGE_SIZE  = 1 << 19;
+
+/*************************************************************
+ * MERGE
+ * Collect per-thread results into one deque, by copying and
+ * with append_deque
+ *************************************************************/
+void benchMerge()
+{
+   std::vector<custom::deque<int>> parts(MERGE_PARTS);
+   for (int iPart = 0; iPart < MERGE_PARTS; iPart++)
+      for (int i = 0; i < MERGE_SIZE + iPart; i++)
+         parts[iPart].push_back(i);
+
+   custom::deque<int> dCopy;
+   Timer timerCopy;
+   for (const custom::deque<int> & part : parts)
+      for (int i = 0; i < (int)part.size(); i++)
+         dCopy.push_back(part[i]);
+   report("merge push_back", (long long)dCopy.size(), timerCopy.seconds());
+
+   custom::deque<int> dAppend;
+   Timer timerAppend;
+   for (custom::deque<int> & part : parts)
+      dAppend.append_deque(std::move(part));
+   report("merge append_deque", (long long)dAppend.size(), timerAppend.seconds());
+
+   sink = (long long)(dCopy.size() + dAppend.size());
+}
+
+const int SPLIT_SIZE = 1 << 22;
+
+/*************************************************************
+ * SPLIT
+ * Cut a large deque in half, by moving the back half out one
+ * element at a time and with split_at
+ *************************************************************/
+void benchSplit()
+{
+   custom::deque<int> d;
+   for (int i = 0; i < SPLIT_SIZE; i++)
+      d.push_back(i);
+
+   custom::deque<int> dLoop;
+   Timer timerLoop;
+   for (int i = 0; i < SPLIT_SIZE / 2; i++)
+   {
+      dLoop.push_front(d.back());
+      d.pop_back();
+   }
+   report("split pop_back+push_front", SPLIT_SIZE / 2, timerLoop.seconds());
+
+   d.append_deque(std::move(dLoop));
+   Timer timerSplit;
+   custom::deque<int> dTail = d.split_at(SPLIT_SIZE / 2 + 3);
+   report("split split_at", SPLIT_SIZE / 2, timerSplit.seconds());
+
+   sink = (long long)(d.size() + dTail.size());
+}
+
+const int FILTER_SIZE = 1 << 22;
+
+/*************************************************************
+ * FILTER
+ * Remove a given percentage of the elements with erase_if,
+ * against the erase-remove idiom on std::deque
+ *************************************************************/
+void benchFilterPercent(int percent, const char * nameCustom, const char * nameStd)
+{
+   auto remove = [percent](int value) { return (value * 7919u) % 100u < (unsigned)percent; };
+
+   custom::deque<int> d;
+   std::deque<int> dStd;
+   for (int i = 0; i < FILTER_SIZE; i++)
+   {
+      d.push_back(i);
+      dStd.push_back(i);
+   }
+
+   Timer timerCustom;
+   custom::erase_if(d, remove);
+   report(nameCustom, FILTER_SIZE, timerCustom.seconds());
+
+   Timer timerStd;
+   dStd.erase(std::remove_if(dStd.begin(), dStd.end(), remove), dStd.end());
+   report(nameStd, FILTER_SIZE, timerStd.seconds());
+
+   sink = (long long)(d.size() + dStd.size());
+}
+
+void benchFilter()
+{
+   benchFilterPercent(1,  "erase_if 1%",  "std::deque remove_if 1%");
+   benchFilterPercent(50, "erase_if 50%", "std::deque remove_if 50%");
+   benchFilterPercent(99, "erase_if 99%", "std::deque remove_if 99%");
+}
+
+const int REFILL_SIZE = 1 << 16;
+const int REFILL_OPS  = 256;
+
+/*************************************************************
+ * REFILL
+ * Reload a long-lived scratch deque, with clear and push_back
+ * and with assign
+ *************************************************************/
+void benchRefill()
+{
+   custom::deque<int> d;
+   Timer timerPush;
+   for (int iOp = 0; iOp < REFILL_OPS; iOp++)
+   {
+      d.clear();
+      for (int i = 0; i < REFILL_SIZE; i++)
+         d.push_back(iOp);
+   }
+   report("refill clear+push_back", (long long)REFILL_SIZE * REFILL_OPS, timerPush.seconds());
+
+   Timer timerAssign;
+   for (int iOp = 0; iOp < REFILL_OPS; iOp++)
+      d.assign(REFILL_SIZE, iOp);
+   report("refill assign", (long long)REFILL_SIZE * REFILL_OPS, timerAssign.seconds());
+
+   sink = (long long)d.size();
+}
+
+const int HINT_SIZE = 1 << 12;
+const int HINT_OPS  = 2048;
+
+/*************************************************************
+ * HINT
+ * Build a fresh deque from both ends, growing from empty and
+ * starting from a capacity hint of the final size
+ *************************************************************/
+void benchHint()
+{
+   long long sum = 0;
+   Timer timerDefault;
+   for (int iOp = 0; iOp < HINT_OPS; iOp++)
+   {
+      custom::deque<int> d;
+      for (int i = 0; i < HINT_SIZE / 2; i++)
+      {
+         d.push_back(i);
+         d.push_front(i);
+      }
+      sum += d.back();
+   }
+   report("hint none", (long long)HINT_SIZE * HINT_OPS, timerDefault.seconds());
+
+   const custom::capacity_hint hint(HINT_SIZE);
+   Timer timerHint;
+   for (int iOp = 0; iOp < HINT_OPS; iOp++)
+   {
+      custom::deque<int> d(hint);
+      for (int i = 0; i < HINT_SIZE / 2; i++)
+      {
+         d.push_back(i);
+         d.push_front(i);
+      }
+      sum += d.back();
+   }
+   report("hint capacity_hint", (long long)HINT_SIZE * HINT_OPS, timerHint.seconds());
+   sink = sum;
+}
+
+const int COLD_SIZE   = 1 << 23;
+const int COLD_OPS    = 8;
+const int COLD_SPREAD = 4;
+const int COLD_FLUSH  = 1 << 26;
+
+/*************************************************************
+ * SCATTER ALLOCATOR
+ * Hands out blocks from one arena in a shuffled order, the
+ * way a long-running heap does, so that consecutive blocks
+ * are not next to each other and the hardware cannot guess
+ *************************************************************/
+template <typename T>
+struct ScatterAllocator
+{
+   typedef T value_type;
+   ScatterAllocator() {}
+   template <typename U>
+   ScatterAllocator(const ScatterAllocator<U> &) {}
+
+   T * allocate(size_t num)
+   {
+      assert(num <= slotSize() && iNext < slots().size());
+      return reinterpret_cast<T *>(arena().data() + slots()[iNext++] * slotSize() * sizeof(T));
+   }
+   void deallocate(T *, size_t) {}
+
+   static size_t slotSize() { return 16; }
+   static void prepare(size_t numSlots)
+   {
+      arena().assign(numSlots * slotSize() * sizeof(T), 0);
+      slots().resize(numSlots);
+      for (size_t i = 0; i < numSlots; i++)
+         slots()[i] = i;
+      std::shuffle(slots().begin(), slots().end(), std::mt19937(5489));
+      iNext = 0;
+   }
+   static std::vector<char> & arena()   { static std::vector<char> v;   return v; }
+   static std::vector<size_t> & slots() { static std::vector<size_t> v; return v; }
+   static size_t iNext;
+};
+template <typename T>
+size_t ScatterAllocator<T>::iNext = 0;
+
+template <typename T, typename U>
+bool operator == (const ScatterAllocator<T> &, const ScatterAllocator<U> &) { return true; }
+template <typename T, typename U>
+bool operator != (const ScatterAllocator<T> &, const ScatterAllocator<U> &) { return false; }
+
+/*************************************************************
+ * COLD ITERATE
+ * Walk a deque whose blocks are scattered, after evicting it
+ * from the cache, with the iterator and with for_each_segment.
+ * Build again with -DDEQUE_PREFETCH_DISTANCE=16 to compare
+ *************************************************************/
+void benchCold()
+{
+   typedef custom::deque<int, ScatterAllocator<int>> ScatterDeque;
+   ScatterAllocator<int>::prepare(COLD_SIZE / 16 * COLD_SPREAD);
+   ScatterDeque d;
+   for (int i = 0; i < COLD_SIZE; i++)
+      d.push_back(i);
+   std::vector<char> flush(COLD_FLUSH);
+
+   char nameIterate[64];
+   char nameSegment[64];
+   snprintf(nameIterate, sizeof(nameIterate), "cold iterator (distance %d)", DEQUE_PREFETCH_DISTANCE);
+   snprintf(nameSegment, sizeof(nameSegment), "cold for_each_segment (distance %d)", DEQUE_PREFETCH_DISTANCE);
+
+   long long sum = 0;
+   double seconds = 0.0;
+   for (int iOp = 0; iOp < COLD_OPS; iOp++)
+   {
+      std::fill(flush.begin(), flush.end(), (char)iOp);
+      Timer timer;
+      for (ScatterDeque::iterator it = d.begin(); it != d.end(); ++it)
+         sum += *it;
+      seconds += timer.seconds();
+   }
+   report(nameIterate, (long long)COLD_SIZE * COLD_OPS, seconds);
+
+   seconds = 0.0;
+   for (int iOp = 0; iOp < COLD_OPS; iOp++)
+   {
+      std::fill(flush.begin(), flush.end(), (char)iOp);
+      Timer timer;
+      d.for_each_segment([&sum](const int * p, size_t num)
+      {
+         for (size_t i = 0; i < num; i++)
+            sum += p[i];
+      });
+      seconds += timer.seconds();
+   }
+   report(nameSegment, (long long)COLD_SIZE * COLD_OPS, seconds);
+   sink = sum + flush[COLD_FLUSH / 2];
+}
+
+const int RECLAIM_SIZE = 1 << 22;
+const int RECLAIM_OPS  = 8;
+
+/*************************************************************
+ * RECLAIM
+ * Time on the calling thread to get rid of a big deque: with
+ * clear, and by retiring it to a reclaimer that collects at
+ * idle time or on a background thread. With one CPU the
+ * background thread takes its time slice from the caller
+ *************************************************************/
+void benchReclaim()
+{
+   custom::deque<int> d;
+   double secondsClear = 0.0;
+   for (int iOp = 0; iOp < RECLAIM_OPS; iOp++)
+   {
+      for (int i = 0; i < RECLAIM_SIZE; i++)
+         d.push_back(i);
+      Timer timer;
+      d.clear();
+      secondsClear += timer.seconds();
+   }
+   report("reclaim clear", RECLAIM_OPS, secondsClear);
+
+   custom::deque_reclaimer<int> reclaimer;
+   double secondsRetire = 0.0;
+   double secondsCollect = 0.0;
+   for (int iOp = 0; iOp < RECLAIM_OPS; iOp++)
+   {
+      for (int i = 0; i < RECLAIM_SIZE; i++)
+         d.push_back(i);
+      Timer timerRetire;
+      reclaimer.retire(d);
+      secondsRetire += timerRetire.seconds();
+      Timer timerCollect;
+      reclaimer.collect();
+      secondsCollect += timerCollect.seconds();
+   }
+   report("reclaim retire", RECLAIM_OPS, secondsRetire);
+   report("reclaim collect (idle time)", RECLAIM_OPS, secondsCollect);
+
+   reclaimer.start();
+   double secondsBackground = 0.0;
+   for (int iOp = 0; iOp < RECLAIM_OPS; iOp++)
+   {
+      for (int i = 0; i < RECLAIM_SIZE; i++)
+         d.push_back(i);
+      Timer timer;
+      reclaimer.retire(d);
+      secondsBackground += timer.seconds();
+   }
+   report("reclaim retire (background thread)", RECLAIM_OPS, secondsBackground);
+   reclaimer.stop();
+   sink = (long long)d.size();
+}
+
+const int BUDGET_SIZE = 1 << 20;
+const int BUDGET_OPS  = 16;
+
+/*************************************************************
+ * BUDGET
+ * Fill and drain a deque with std::allocator and with a
+ * budget_allocator, to price the accounting per block
+ *************************************************************/
+template <class Deque>
+void benchBudgetOf(const char * name, Deque & d)
+{
+   long long sum = 0;
+   Timer timer;
+   for (int iOp = 0; iOp < BUDGET_OPS; iOp++)
+   {
+      for (int i = 0; i < BUDGET_SIZE; i++)
+         d.push_back(i);
+      while (!d.empty())
+      {
+         sum += d.front();
+         d.pop_front();
+      }
+   }
+   report(name, 2LL * BUDGET_SIZE * BUDGET_OPS, timer.seconds());
+   sink = sum;
+}
+
+void benchBudget()
+{
+   custom::deque<int> d;
+   benchBudgetOf("budget std::allocator push+pop", d);
+
+   custom::deque_budget budget(BUDGET_SIZE * sizeof(int) * 2);
+   custom::deque<int, custom::budget_allocator<int>> dBudget(budget);
+   benchBudgetOf("budget budget_allocator push+pop", dBudget);
+}
+
+const int MAP_LOG_FIRST = 20;
+const int MAP_LOG_LAST  = 23;
+
+/*************************************************************
+ * MAP GROWTH
+ * Time the one push_back that doubles the map, from 1M to
+ * 16M blocks. A flat map is copied (or mremapped); a chunked
+ * map only rebuilds its directory. Build again with
+ * -DDEQUE_MREMAP_THRESHOLD=0 for the copying baseline
+ *************************************************************/
+template <class P>
+void benchMapGrowthOf(const char * mapName)
+{
+   // 16 cells per block, filled from the back: the map is full
+   // exactly when the size reaches 16 times a power of two
+   custom::deque<char, std::allocator<char>, P> d;
+   for (int log = MAP_LOG_FIRST; log <= MAP_LOG_LAST; log++)
+   {
+      size_t numFull = (size_t)16 << log;
+      while (d.size() < numFull)
+         d.push_back('x');
+
+      Timer timer;
+      d.push_back('y');
+      double seconds = timer.seconds();
+
+      char name[64];
+      snprintf(name, sizeof(name), "map %s %dM->%dM blocks (mremap >= %d)",
+               mapName, 1 << (log - 20), 2 << (log - 20), DEQUE_MREMAP_THRESHOLD);
+      report(name, 1, seconds);
+   }
+   sink = (long long)d.size();
+}
+
+/*************************************************************
+ * MAP READ
+ * What the chunked map's second load costs operator[]
+ *************************************************************/
+template <class P>
+void benchMapReadOf(const char * name)
+{
+   custom::deque<int, std::allocator<int>, P> d;
+   for (int i = 0; i < GATHER_SIZE; i++)
+      d.push_front(i);
+
+   std::mt19937 gen(5489u);
+   std::vector<int> ids(GATHER_OPS);
+   for (int & id : ids)
+      id = (int)(gen() % GATHER_SIZE);
+
+   long long sum = 0;
+   Timer timer;
+   for (int i = 0; i < GATHER_OPS; i++)
+      sum += d[ids[i]];
+   report(name, GATHER_OPS, timer.seconds());
+   sink = sum;
+}
+
+void benchMapGrowth()
+{
+   benchMapGrowthOf<custom::default_policy>("flat");
+   benchMapGrowthOf<custom::with_map<custom::map_chunked<>>>("chunked");
+   benchMapReadOf<custom::default_policy>("map flat random_read operator[]");
+   benchMapReadOf<custom::with_map<custom::map_chunked<>>>("map chunked random_read operator[]");
+}
+
+const int GEOMETRIC_SIZE = 1 << 25;
+
+/*************************************************************
+ * COUNTING ALLOCATOR
+ * std::allocator that counts the blocks it hands out. One
+ * count for every rebinding, so aligned blocks count too
+ *************************************************************/
+long long numAllocations = 0;
+
+template <typename T>
+struct CountingAllocator
+{
+   typedef T value_type;
+   CountingAllocator() {}
+   template <typename U>
+   CountingAllocator(const CountingAllocator<U> &) {}
+
+   T * allocate(size_t num)
+   {
+      numAllocations++;
+      return std::allocator<T>().allocate(num);
+   }
+   void deallocate(T * p, size_t num) { std::allocator<T>().deallocate(p, num); }
+};
+
+template <typename T, typename U>
+bool operator == (const CountingAllocator<T> &, const CountingAllocator<U> &) { return true; }
+template <typename T, typename U>
+bool operator != (const CountingAllocator<T> &, const CountingAllocator<U> &) { return false; }
+
+/*************************************************************
+ * GEOMETRIC
+ * Fixed 16-cell blocks against doubling blocks: fill from
+ * both ends, walk, read at random, drain from the front
+ *************************************************************/
+template <class Deque>
+void benchGeometricOf(const char * kind)
+{
+   char name[64];
+   numAllocations = 0;
+   Deque d;
+
+   Timer timerFill;
+   for (int i = 0; i < GEOMETRIC_SIZE / 2; i++)
+   {
+      d.push_back(i);
+      d.push_front(i);
+   }
+   snprintf(name, sizeof(name), "%s push_back+push_front", kind);
+   report(name, GEOMETRIC_SIZE, timerFill.seconds());
+   printf("%-40s %12lld\n", "   blocks allocated", numAllocations);
+
+   long long sum = 0;
+   Timer timerWalk;
+   d.for_each_segment([&sum](const int * p, size_t num)
+   {
+      for (size_t i = 0; i < num; i++)
+         sum += p[i];
+   });
+   snprintf(name, sizeof(name), "%s for_each_segment", kind);
+   report(name, GEOMETRIC_SIZE, timerWalk.seconds());
+
+   std::mt19937 gen(5489u);
+   std::vector<int> ids(GATHER_OPS);
+   for (int & id : ids)
+      id = (int)(gen() % GEOMETRIC_SIZE);
+   Timer timerRead;
+   for (int i = 0; i < GATHER_OPS; i++)
+      sum += d[ids[i]];
+   snprintf(name, sizeof(name), "%s random_read operator[]", kind);
+   report(name, GATHER_OPS, timerRead.seconds());
+
+   Timer timerDrain;
+   while (!d.empty())
+      d.pop_front();
+   snprintf(name, sizeof(name), "%s pop_front", kind);
+   report(name, GEOMETRIC_SIZE, timerDrain.seconds());
+   sink = sum;
+}
+
+void benchGeometric()
+{
+   benchGeometricOf<custom::deque<int, CountingAllocator<int>>>("fixed");
+   benchGeometricOf<custom::geometric_deque<int, CountingAllocator<int>>>("geometric");
+}
+
+const int POLICY_SIZE = 1 << 12;
+const int POLICY_OPS  = 1 << 24;
+
+/*************************************************************
+ * POLICY
+ * A queue holding a steady few thousand elements, one push
+ * and one pop per operation, under each preset policy
+ *************************************************************/
+template <class P>
+void benchPolicyOf(const char * name)
+{
+   numAllocations = 0;
+   custom::queue<int, CountingAllocator<int>, P> q;
+   for (int i = 0; i < POLICY_SIZE; i++)
+      q.push(i);
+
+   long long sum = 0;
+   Timer timer;
+   for (int i = 0; i < POLICY_OPS; i++)
+   {
+      sum += q.front();
+      q.pop();
+      q.push(i);
+   }
+   report(name, POLICY_OPS, timer.seconds());
+   printf("%-40s %12lld\n", "   blocks allocated", numAllocations);
+   sink = sum;
+}
+
+void benchPolicy()
+{
+   benchPolicyOf<custom::default_policy>("policy default queue push+pop");
+   benchPolicyOf<custom::low_latency>("policy low_latency queue push+pop");
+   benchPolicyOf<custom::low_memory>("policy low_memory queue push+pop");
+   benchPolicyOf<custom::throughput>("policy throughput queue push+pop");
+}
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+const int MEMORY_BIG    = 1 << 22;
+const int MEMORY_SMALL  = 32;
+const int MEMORY_DEQUES = 1 << 16;
+
+/*************************************************************
+ * USABLE ALLOCATOR
+ * malloc, with allocate_at_least telling the deque how much
+ * of each request malloc really handed over
+ *************************************************************/
+template <typename T>
+struct UsableAllocator
+{
+   typedef T value_type;
+   struct result
+   {
+      T * ptr;
+      size_t count;
+   };
+   UsableAllocator() {}
+   template <typename U>
+   UsableAllocator(const UsableAllocator<U> &) {}
+
+   T * allocate(size_t num)
+   {
+      void * p = malloc(num * sizeof(T));
+      if (p == nullptr)
+         throw std::bad_alloc();
+      return static_cast<T *>(p);
+   }
+   result allocate_at_least(size_t num)
+   {
+      T * p = allocate(num);
+      return { p, malloc_usable_size(p) / sizeof(T) };
+   }
+   void deallocate(T * p, size_t) { free(p); }
+};
+
+template <typename T, typename U>
+bool operator == (const UsableAllocator<T> &, const UsableAllocator<U> &) { return true; }
+template <typename T, typename U>
+bool operator != (const UsableAllocator<T> &, const UsableAllocator<U> &) { return false; }
+
+// bytes of heap in use, malloc's headers and rounding included
+size_t heapBytes()
+{
+   struct mallinfo2 info = mallinfo2();
+   return info.uordblks + info.hblkhd;
+}
+
+/*************************************************************
+ * MEMORY
+ * Heap bytes per int for one big deque and for many small
+ * ones, under each way of sizing blocks. 4 is no waste
+ *************************************************************/
+template <class Deque>
+void benchMemoryOf(const char * kind)
+{
+   char name[64];
+   {
+      size_t numBefore = heapBytes();
+      Deque d;
+      for (int i = 0; i < MEMORY_BIG; i++)
+         d.push_back(i);
+      snprintf(name, sizeof(name), "memory %s 4M ints", kind);
+      printf("%-40s %12.3f bytes/int\n", name,
+             (double)(heapBytes() - numBefore) / MEMORY_BIG);
+   }
+   {
+      // every size from 1 to 32 ints, equally often
+      std::vector<Deque> deques(MEMORY_DEQUES);
+      size_t numBefore = heapBytes();
+      long long numInts = 0;
+      for (int id = 0; id < MEMORY_DEQUES; id++)
+         for (int i = 0; i <= id % MEMORY_SMALL; i++, numInts++)
+            deques[id].push_back(i);
+      snprintf(name, sizeof(name), "memory %s 64K x 1-32 ints", kind);
+      printf("%-40s %12.3f bytes/int\n", name,
+             (double)(heapBytes() - numBefore) / (double)numInts);
+   }
+}
+
+void benchMemory()
+{
+   benchMemoryOf<custom::deque<int>>("default");
+   benchMemoryOf<custom::deque<int, UsableAllocator<int>>>("allocate_at_least");
+   benchMemoryOf<custom::deque<int, std::allocator<int>, custom::low_memory>>("low_memory");
+   benchMemoryOf<custom::deque<int, std::allocator<int>, custom::throughput>>("throughput");
+}
+#else
+void benchMemory()
+{
+   printf("memory: needs glibc 2.33 for mallinfo2\n");
+}
+#endif // __GLIBC__
+
+const int PARALLEL_INTS    = 1 << 23;
+const int PARALLEL_STRINGS = 1 << 20;
+const int PARALLEL_OPS     = 4;
+
+/*************************************************************
+ * PARALLEL COPY
+ * Copy a big deque with the copy constructor, then with
+ * parallel_copy on pools of growing size. Per element copied
+ *************************************************************/
+template <typename T>
+void benchParallelCopyOf(const char * kind, const custom::deque<T> & d)
+{
+   char name[64];
+   long long sum = 0;
+   {
+      Timer timer;
+      for (int iOp = 0; iOp < PARALLEL_OPS; iOp++)
+      {
+         custom::deque<T> dCopy(d);
+         sum += (long long)dCopy.size();
+      }
+      snprintf(name, sizeof(name), "parallel_copy %s serial", kind);
+      report(name, (long long)d.size() * PARALLEL_OPS, timer.seconds());
+   }
+
+   unsigned numHardware = std::max(1u, std::thread::hardware_concurrency());
+   for (unsigned numThreads = 1; numThreads <= std::max(4u, numHardware); numThreads *= 2)
+   {
+      custom::deque_thread_pool pool(numThreads);
+      Timer timer;
+      for (int iOp = 0; iOp < PARALLEL_OPS; iOp++)
+      {
+         custom::deque<T> dCopy = custom::parallel_copy(d, pool);
+         sum += (long long)dCopy.size();
+      }
+      snprintf(name, sizeof(name), "parallel_copy %s %u threads", kind, numThreads);
+      report(name, (long long)d.size() * PARALLEL_OPS, timer.seconds());
+   }
+   sink = sum;
+}
+
+void benchParallelCopy()
+{
+   printf("%-40s %12u\n", "parallel_copy hardware threads",
+          std::thread::hardware_concurrency());
+   {
+      custom::deque<int> d;
+      for (int i = 0; i < PARALLEL_INTS; i++)
+         d.push_back(i);
+      benchParallelCopyOf("8M ints", d);
+   }
+   {
+      // long enough to live on the heap
+      custom::deque<std::string> d;
+      for (int i = 0; i < PARALLEL_STRINGS; i++)
+         d.push_back(std::string(32, static_cast<char>('a' + i % 26)));
+      benchParallelCopyOf("1M strings", d);
+   }
+}
+
+/*************************************************************
+ * PARALLEL CLEAR
+ * Empty a deque of heap strings with clear(), then with
+ * parallel_clear on pools of growing size. Per element
+ * destroyed; only the clear is timed
+ *************************************************************/
+void fillStrings(custom::deque<std::string> & d)
+{
+   for (int i = 0; i < PARALLEL_STRINGS; i++)
+      d.push_back(std::string(32, static_cast<char>('a' + i % 26)));
+}
+
+void benchParallelClear()
+{
+   char name[64];
+   double seconds = 0.0;
+   for (int iOp = 0; iOp < PARALLEL_OPS; iOp++)
+   {
+      custom::deque<std::string> d;
+      fillStrings(d);
+      Timer timer;
+      d.clear();
+      seconds += timer.seconds();
+   }
+   report("parallel_clear 1M strings serial", (long long)PARALLEL_STRINGS * PARALLEL_OPS, seconds);
+
+   unsigned numHardware = std::max(1u, std::thread::hardware_concurrency());
+   for (unsigned numThreads = 1; numThreads <= std::max(4u, numHardware); numThreads *= 2)
+   {
+      custom::deque_thread_pool pool(numThreads);
+      seconds = 0.0;
+      for (int iOp = 0; iOp < PARALLEL_OPS; iOp++)
+      {
+         custom::deque<std::string> d;
+         fillStrings(d);
+         Timer timer;
+         custom::parallel_clear(d, pool);
+         seconds += timer.seconds();
+      }
+      snprintf(name, sizeof(name), "parallel_clear 1M strings %u threads", numThreads);
+      report(name, (long long)PARALLEL_STRINGS * PARALLEL_OPS, seconds);
+   }
+}
+
+const int ADAPTER_SIZE = 1 << 20;
+const int ADAPTER_OPS  = 16;
+
+/*************************************************************
+ * ADAPTERS
+ * Fill and empty a queue and a stack, with the std adapters
+ * over std::deque and with ours
+ *************************************************************/
+template <class Queue>
+void benchQueueOf(const char * name)
+{
+   Queue q;
+   long long sum = 0;
+   Timer timer;
+   for (int iOp = 0; iOp < ADAPTER_OPS; iOp++)
+   {
+      for (int i = 0; i < ADAPTER_SIZE; i++)
+         q.push(i);
+      while (!q.empty())
+      {
+         sum += q.front();
+         q.pop();
+      }
+   }
+   report(name, 2LL * ADAPTER_SIZE * ADAPTER_OPS, timer.seconds());
+   sink = sum;
+}
+
+template <class Stack>
+void benchStackOf(const char * name)
+{
+   Stack s;
+   long long sum = 0;
+   Timer timer;
+   for (int iOp = 0; iOp < ADAPTER_OPS; iOp++)
+   {
+      for (int i = 0; i < ADAPTER_SIZE; i++)
+         s.push(i);
+      while (!s.empty())
+      {
+         sum += s.top();
+         s.pop();
+      }
+   }
+   report(name, 2LL * ADAPTER_SIZE * ADAPTER_OPS, timer.seconds());
+   sink = sum;
+}
+
+void benchAdapters()
+{
+   benchQueueOf<std::queue<int>>                     ("queue std::queue push+pop");
+   benchQueueOf<std::queue<int, custom::deque<int>>> ("queue std::queue<custom::deque> push+pop");
+   benchQueueOf<custom::queue<int>>                  ("queue custom::queue push+pop");
+   benchStackOf<std::stack<int>>                     ("stack std::stack push+pop");
+   benchStackOf<std::stack<int, custom::deque<int>>> ("stack std::stack<custom::deque> push+pop");
+   benchStackOf<custom::stack<int>>                  ("stack custom::stack push+pop");
+}
+
+/*************************************************************
+ * BENCHMARKS
+ * Every benchmark, by the name used for filtering
+ *************************************************************/
+struct Benchmark
+{
+   const char * name;
+   void (*run)();
+};
+
+const Benchmark benchmarks[] =
+{
+   { "shift_int",          benchShiftInt               },
+   { "shift_handle",       benchShiftHandle            },
+   { "shift_reloc_handle", benchShiftRelocatableHandle },
+   { "gather",             benchGather                 },
+   { "drain",              benchDrain                  },
+   { "rebalance",          benchRebalance              },
+   { "merge",              benchMerge                  },
+   { "split",              benchSplit                  },
+   { "filter",             benchFilter                 },
+   { "refill",             benchRefill                 },
+   { "adapters",           benchAdapters               },
+   { "hint",               benchHint                   },
+   { "cold",               benchCold                   },
+   { "reclaim",            benchReclaim                },
+   { "budget",             benchBudget                 },
+   { "map_growth",         benchMapGrowth              },
+   { "geometric",          benchGeometric              },
+   { "policy",             benchPolicy                 },
+   { "memory",             benchMemory                 },
+   { "parallel_copy",      benchParallelCopy           },
+   { "parallel_clear",     benchParallelClear          },
+};
+
+} // namespace
+
+namespace custom
+{
+   template <>
+   struct is_trivially_relocatable<RelocatableHandle> : std::true_type {};
+}
+
+/**********************************************************************
+ * MAIN
+ * Run every benchmark whose name contains the filter
+ ***********************************************************************/
+int main(int argc, char ** argv)
+{
+   const char * filter = argc > 1 ? argv[1] : "";
+   for (const Benchmark & benchmark : benchmarks)
+      if (strstr(benchmark.name, filter))
+         benchmark.run();
+   return 0;
+}
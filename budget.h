@@ -0,0 +1,172 @@
+/***********************************************************************
+ * Header:
+ *    BUDGET
+ * Summary:
+ *    A memory cap shared by any number of deques. Each deque joins by
+ *    using a budget_allocator bound to the budget, so every block it
+ *    allocates or frees is counted against one byte limit. When a block
+ *    would go over the limit the budget calls its eviction callback,
+ *    which may free blocks elsewhere (pop from another deque, trim it)
+ *    and ask to retry. If it cannot, the allocation throws
+ *    std::bad_alloc and the deque is left as it was: backpressure.
+ *
+ *    Only blocks are counted; the map of block pointers is not.
+ *
+ *    This will contain the class definition of:
+ *        deque_budget          : The shared limit and running total
+ *        budget_allocator      : An allocator that charges a deque_budget
+ * Author
+ *    Marco Varela & Andre Regino
+ ************************************************************************/
+
+#pragma once
+
+#include "deque.h"     // for custom::deque
+#include <atomic>      // for std::atomic
+#include <functional>  // for std::function
+#include <memory>      // for std::allocator
+#include <mutex>       // for std::mutex
+#include <new>         // for std::bad_alloc
+
+namespace custom
+{
+
+/******************************************************
+ * DEQUE BUDGET
+ * A byte limit and the bytes charged against it.
+ * Charging and releasing are thread safe; the callback
+ * runs on whichever thread went over. set_evict may be
+ * called while other threads charge: a charge already
+ * in the callback finishes with the old one
+ *****************************************************/
+class deque_budget
+{
+public:
+   // given the bytes that did not fit, free some and return true to
+   // retry, or return false to refuse the allocation
+   typedef std::function<bool(size_t numBytes)> evict_function;
+
+   //
+   // Construct
+   //
+   explicit deque_budget(size_t numBytesLimit, evict_function evict = nullptr) :
+      numBytesLimit(numBytesLimit), numBytesUsed(0), evict(evict) {}
+   deque_budget(const deque_budget &) = delete;
+   deque_budget & operator = (const deque_budget &) = delete;
+
+   //
+   // Charge
+   //
+   void charge(size_t numBytes);
+   bool try_charge(size_t numBytes);
+   void release(size_t numBytes) { numBytesUsed -= numBytes; }
+
+   //
+   // Status
+   //
+   size_t used()      const { return numBytesUsed; }
+   size_t limit()     const { return numBytesLimit; }
+   size_t available() const
+   {
+      size_t numUsed = numBytesUsed;
+      return numUsed < numBytesLimit ? numBytesLimit - numUsed : 0;
+   }
+   void set_limit(size_t numBytes)          { numBytesLimit = numBytes; }
+   void set_evict(evict_function evictNew)
+   {
+      std::lock_guard<std::mutex> lock(mutexEvict);
+      evict = std::move(evictNew);
+   }
+
+private:
+   std::atomic<size_t> numBytesLimit;  // never charge past this
+   std::atomic<size_t> numBytesUsed;   // the blocks allocated right now
+   std::mutex mutexEvict;              // guards evict
+   evict_function evict;               // asked to make room when full
+};
+
+/*****************************************
+ * DEQUE BUDGET :: TRY CHARGE
+ * Count numBytes if they fit under the limit
+ ****************************************/
+inline bool deque_budget::try_charge(size_t numBytes)
+{
+   size_t numUsed = numBytesUsed;
+   do
+   {
+      if (numBytes > numBytesLimit || numUsed > numBytesLimit - numBytes)
+         return false;
+   }
+   while (!numBytesUsed.compare_exchange_weak(numUsed, numUsed + numBytes));
+   return true;
+}
+
+/*****************************************
+ * DEQUE BUDGET :: CHARGE
+ * Count numBytes, asking the callback to make
+ * room for as long as they do not fit. The callback
+ * runs on a copy, outside the lock, so it may free
+ * or allocate on this budget itself
+ ****************************************/
+inline void deque_budget::charge(size_t numBytes)
+{
+   while (!try_charge(numBytes))
+   {
+      evict_function evictNow;
+      {
+         std::lock_guard<std::mutex> lock(mutexEvict);
+         evictNow = evict;
+      }
+      if (!evictNow || !evictNow(numBytes))
+         throw std::bad_alloc();
+   }
+}
+
+/******************************************************
+ * BUDGET ALLOCATOR
+ * std::allocator, charged to a deque_budget. Two are
+ * equal when they share a budget, so deques on the same
+ * budget can still hand each other blocks
+ *****************************************************/
+template <typename T>
+class budget_allocator
+{
+public:
+   typedef T value_type;
+
+   budget_allocator(deque_budget & budget) : budget(&budget) {}
+   template <typename U>
+   budget_allocator(const budget_allocator<U> & rhs) : budget(rhs.budget) {}
+
+   T * allocate(size_t num)
+   {
+      budget->charge(num * sizeof(T));
+      try
+      {
+         return std::allocator<T>().allocate(num);
+      }
+      catch (...)
+      {
+         budget->release(num * sizeof(T));
+         throw;
+      }
+   }
+   void deallocate(T * p, size_t num)
+   {
+      std::allocator<T>().deallocate(p, num);
+      budget->release(num * sizeof(T));
+   }
+
+   template <typename U>
+   bool operator == (const budget_allocator<U> & rhs) const { return budget == rhs.budget; }
+   template <typename U>
+   bool operator != (const budget_allocator<U> & rhs) const { return budget != rhs.budget; }
+
+private:
+   template <typename U>
+   friend class budget_allocator;
+
+   deque_budget * budget;      // where the blocks are counted
+};
+
+} // namespace custom
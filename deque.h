@@ -2,7 +2,7 @@
  * Header:
  *    DEQUE
  * Summary:
- *    Our custom implementation of a deque 
+ *    Our custom implementation of a deque
  *      __      __     _______        __
  *     /  |    /  |   |  _____|   _  / /
  *     `| |    `| |   | |____    (_)/ /
@@ -21,129 +21,638 @@
 
 // Debug stuff
 #include <cassert>
-#include <memory>   // for std::allocator
+#include <memory>      // for std::allocator
+#include <utility>     // for std::move
+#include <algorithm>   // for std::min, std::sort
+#include <cstring>     // for std::memmove
+#include <type_traits> // for std::is_trivially_copyable
+#include <new>         // for std::bad_alloc
+#include <cstddef>     // for std::nullptr_t
 
 class TestDeque;    // forward declaration for TestDeque unit test class
+class TestQueue;    // the adapters' tests look inside their deque too
+class TestStack;
+class TestParallel;
+
+// C++20 allows transient allocation in constant expressions, so the
+// deque can be built, used, and destroyed at compile time
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#define DEQUE_CONSTEXPR constexpr
+#else
+#define DEQUE_CONSTEXPR
+#endif
+
+// hint that an address will be read soon
+#if defined(__GNUC__) || defined(__clang__)
+#define DEQUE_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define DEQUE_PREFETCH(p) ((void)(p))
+#endif
+
+// how many blocks ahead sequential traversal starts loading; 0 turns it off.
+// Off by default: the cold benchmark has not shown a win, and it costs a
+// divide and a branch on every iterator increment. Try 16 on machines
+// whose hardware prefetcher loses track across scattered blocks
+#ifndef DEQUE_PREFETCH_DISTANCE
+#define DEQUE_PREFETCH_DISTANCE 0
+#endif
+
+// on Linux, a map of at least this many bytes gets its own mapping and
+// grows with mremap, which moves page tables instead of copying pointers.
+// 0 turns it off
+#ifndef DEQUE_MREMAP_THRESHOLD
+#if defined(__linux__)
+#define DEQUE_MREMAP_THRESHOLD (1 << 20)
+#else
+#define DEQUE_MREMAP_THRESHOLD 0
+#endif
+#endif
+#if DEQUE_MREMAP_THRESHOLD > 0
+#include <sys/mman.h>  // for mmap, mremap, munmap
+#endif
 
 namespace custom
 {
 
+/******************************************************
+ * IS TRIVIALLY RELOCATABLE
+ * True when moving a T and then destroying the source
+ * is the same as copying its bytes. Trivially copyable
+ * types qualify; specialize this to opt in others, such
+ * as a class that only holds a std::unique_ptr
+ *****************************************************/
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+/******************************************************
+ * CAPACITY HINT
+ * How many elements a deque expects to hold at once,
+ * and how many of those will come in on the front
+ *****************************************************/
+struct capacity_hint
+{
+   constexpr explicit capacity_hint(size_t num) : num(num), numFront(num / 2) {}
+   constexpr capacity_hint(size_t num, size_t numFront) : num(num), numFront(numFront) {}
+   size_t num;
+   size_t numFront;
+};
+
+/******************************************************
+ * CHUNKED MAP
+ * The block pointers in chunks of F under a directory,
+ * so finding a block is two dependent loads and growing
+ * the map only reallocates the directory. Indexes like
+ * an array of block pointers
+ *****************************************************/
+template <typename T, size_t F>
+class chunked_map
+{
+public:
+   static_assert(F > 0 && (F & (F - 1)) == 0, "the fanout must be a power of two");
+
+   DEQUE_CONSTEXPR chunked_map(std::nullptr_t = nullptr) : chunks(nullptr) {}
+
+   DEQUE_CONSTEXPR T *& operator [] (int ib) const
+   {
+      return chunks[static_cast<size_t>(ib) / F][static_cast<size_t>(ib) % F];
+   }
+
+   DEQUE_CONSTEXPR bool operator == (std::nullptr_t) const { return chunks == nullptr; }
+   DEQUE_CONSTEXPR bool operator != (std::nullptr_t) const { return chunks != nullptr; }
+
+   T *** chunks;              // the directory: each entry holds F block pointers
+};
+
+/******************************************************
+ * BLOCK MAPS
+ * How a deque keeps the pointers to its blocks
+ *    map_flat       : one array, reallocated to grow (the default)
+ *    map_chunked<F> : chunks of F pointers under a directory, for
+ *                     enormous deques whose map should never be one
+ *                     giant allocation. The map is a whole number of
+ *                     chunks, so even a small deque has F slots
+ *****************************************************/
+struct map_flat
+{
+   template <typename T>
+   using type = T **;
+};
+
+template <size_t F = 512>
+struct map_chunked
+{
+   template <typename T>
+   using type = chunked_map<T, F>;
+};
+
+// raw storage a block is carved from when it must be over-aligned
+template <size_t N>
+struct alignas(N) aligned_unit
+{
+   unsigned char bytes[N];
+};
+
+/******************************************************
+ * MALLOC SIZE CLASS
+ * The bytes malloc really hands out for a small request
+ * of numBytes. glibc puts an 8-byte header in front and
+ * rounds to 16; jemalloc, tcmalloc, and the macOS and
+ * Windows heaps round to classes 16 apart up to 128,
+ * then four to each doubling
+ *****************************************************/
+constexpr size_t malloc_size_class(size_t numBytes)
+{
+#if defined(__GLIBC__)
+   return numBytes + 8 <= 32 ? 24 : ((numBytes + 8 + 15) & ~static_cast<size_t>(15)) - 8;
+#else
+   if (numBytes <= 128)
+      return (numBytes + 15) & ~static_cast<size_t>(15);
+   size_t spacing = 16;
+   while (spacing * 8 < numBytes)
+      spacing *= 2;
+   return (numBytes + spacing - 1) / spacing * spacing;
+#endif
+}
+
+/******************************************************
+ * STATISTICS
+ * What a deque counts about its memory, if anything.
+ *    no_stats    : counts nothing and costs nothing
+ *    deque_stats : blocks allocated and freed, map growths
+ *****************************************************/
+struct no_stats
+{
+   DEQUE_CONSTEXPR void blockAllocated() {}
+   DEQUE_CONSTEXPR void blockFreed()     {}
+   DEQUE_CONSTEXPR void mapGrown()       {}
+};
+
+struct deque_stats
+{
+   DEQUE_CONSTEXPR void blockAllocated() { ++numBlockAllocations; }
+   DEQUE_CONSTEXPR void blockFreed()     { ++numBlockFrees;       }
+   DEQUE_CONSTEXPR void mapGrown()       { ++numMapGrowths;       }
+
+   size_t numBlockAllocations = 0;   // blocks taken from the allocator
+   size_t numBlockFrees = 0;         // blocks given back to it
+   size_t numMapGrowths = 0;         // times the map of blocks grew
+};
+
+/******************************************************
+ * POLICIES
+ * The third template parameter of deque bundles how it
+ * manages memory. Derive from default_policy and hide
+ * what should change:
+ *    map                  : map_flat or map_chunked<F>
+ *    stats                : no_stats or deque_stats
+ *    block_cells<T>()     : cells in a block
+ *    grow(numBlocks)      : map size to grow to when full
+ *    cache_spare_blocks() : do pops keep emptied blocks for
+ *                           the next push? trim() frees them
+ *    block_alignment()    : bytes to align blocks to, beyond
+ *                           alignof(T). Over-aligned blocks need
+ *                           C++17 for std::allocator to honor it
+ *    fit_size_class()     : grow blocks and the flat map to fill
+ *                           their malloc size class, so the bytes
+ *                           malloc rounds up to hold elements
+ *****************************************************/
+struct default_policy
+{
+   typedef map_flat map;
+   typedef no_stats stats;
+   template <typename T>
+   static constexpr size_t block_cells()         { return 16; }
+   static constexpr size_t grow(size_t numBlocks) { return numBlocks * 2; }
+   static constexpr bool cache_spare_blocks()     { return false; }
+   static constexpr size_t block_alignment()      { return 0; }
+   static constexpr bool fit_size_class()         { return false; }
+};
+
+// keep any policy, but with another block map or with statistics
+template <typename Map, typename Base = default_policy>
+struct with_map : Base
+{
+   typedef Map map;
+};
+
+template <typename Base = default_policy>
+struct with_stats : Base
+{
+   typedef deque_stats stats;
+};
+
+// no allocator calls once warm: blocks are kept, a cache line each or more
+struct low_latency : default_policy
+{
+   template <typename T>
+   static constexpr size_t block_cells()      { return sizeof(T) >= 32 ? 16 : 512 / sizeof(T); }
+   static constexpr bool cache_spare_blocks() { return true; }
+   static constexpr size_t block_alignment()  { return 64; }
+};
+
+// small blocks that fill their size class, freed at once, and a
+// map that grows by half
+struct low_memory : default_policy
+{
+   static constexpr size_t grow(size_t numBlocks) { return numBlocks + numBlocks / 2 + 1; }
+   static constexpr bool fit_size_class()         { return true; }
+};
+
+// page-sized blocks for long runs and few allocator calls
+struct throughput : default_policy
+{
+   template <typename T>
+   static constexpr size_t block_cells()     { return sizeof(T) >= 256 ? 16 : 4096 / sizeof(T); }
+   static constexpr size_t block_alignment() { return 64; }
+};
+
+template <typename T, typename A, typename P> class queue;   // adapters that keep their
+template <typename T, typename A, typename P> class stack;   // own cursors into the blocks
+template <typename T, typename A, typename P> class deque_reclaimer;
+template <typename T, typename A, typename P> class deque_parallel;
+
 /******************************************************
  * DEQUE
  *****************************************************/
-template <typename T, typename A = std::allocator<T>>
+template <typename T, typename A = std::allocator<T>, typename P = default_policy>
 class deque
 {
    friend class ::TestDeque; // give unit tests access to the privates
+   friend class ::TestQueue;
+   friend class ::TestStack;
+   friend class ::TestParallel;
+   friend class queue<T, A, P>;
+   friend class stack<T, A, P>;
+   friend class deque_reclaimer<T, A, P>;
+   friend class deque_parallel<T, A, P>;
 public:
+   // what std::queue and std::stack expect of their container
+   typedef T         value_type;
+   typedef size_t    size_type;
+   typedef T &       reference;
+   typedef const T & const_reference;
 
-   // 
+   //
    // Construct
    //
-   deque(const A& a = A()) : alloc(a), numCells(16), numBlocks(0), numElements(0), iaFront(0), data(nullptr) {}
+   DEQUE_CONSTEXPR deque(const A& a = A()) : alloc(a), numCells(blockCells()), numBlocks(0), numElements(0), iaFront(0), data(nullptr) {}
+
+   DEQUE_CONSTEXPR explicit deque(const capacity_hint & hint, const A& a = A());
 
-   deque(deque& rhs);
+   DEQUE_CONSTEXPR deque(const deque& rhs);
 
-   ~deque()
+   DEQUE_CONSTEXPR deque(deque&& rhs) noexcept : alloc(rhs.alloc), numCells(rhs.numCells), numBlocks(0), numElements(0), iaFront(0), data(nullptr)
    {
-//      clear();
+      swapState(rhs);
+   }
+
+   DEQUE_CONSTEXPR ~deque()
+   {
+      clear();
+      freeMap(data, numBlocks);
    }
 
    //
    // Assign
    //
-   deque & operator = (deque& rhs);
+   DEQUE_CONSTEXPR deque & operator = (const deque& rhs);
+   DEQUE_CONSTEXPR void assign(size_t num, const T & t);
+   template <class InputIt,
+             class = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+   DEQUE_CONSTEXPR void assign(InputIt first, InputIt last);
 
-   // 
+   //
    // Iterator
    //
    class iterator;
-   iterator begin() 
-   { 
+   DEQUE_CONSTEXPR iterator begin()
+   {
       return iterator(0, this);
    }
-   iterator end()   
-   { 
+   DEQUE_CONSTEXPR iterator end()
+   {
       return iterator(static_cast<int>(numElements), this);
    }
 
-   // 
+   //
    // Access
    //
-   T & front()       
-   { 
+   DEQUE_CONSTEXPR T & front()
+   {
       return data[ibFromID(0)][icFromID(0)];
    }
-   const T & front() const 
+   DEQUE_CONSTEXPR const T & front() const
    {
       return data[ibFromID(0)][icFromID(0)];
    }
-   T & back()
+   DEQUE_CONSTEXPR T & back()
    {
       return data[ibFromID(static_cast<int>(numElements) - 1)][icFromID(static_cast<int>(numElements) - 1)];
    }
-   const T & back() const
+   DEQUE_CONSTEXPR const T & back() const
    {
-      return data[ibFromID(numElements - 1)][icFromID(numElements - 1)];
+      return data[ibFromID(static_cast<int>(numElements) - 1)][icFromID(static_cast<int>(numElements) - 1)];
    }
-   T & operator[](int id)
+   DEQUE_CONSTEXPR T & operator[](int id)
    {
       return data[ibFromID(id)][icFromID(id)];
    }
-   const T & operator[](int id) const
+   DEQUE_CONSTEXPR const T & operator[](int id) const
    {
       return data[ibFromID(id)][icFromID(id)];
    }
+   void gather(const int * ids, size_t num, T * out, bool sortByBlock = false) const;
 
    //
    // Insert
    //
-   void push_back(const T & t);
-   void push_back(T && t);
-   void push_front(const T& t);
-   void push_front(T&& t);
+   DEQUE_CONSTEXPR void push_back(const T & t);
+   DEQUE_CONSTEXPR void push_back(T && t);
+   DEQUE_CONSTEXPR void push_front(const T& t);
+   DEQUE_CONSTEXPR void push_front(T&& t);
+   DEQUE_CONSTEXPR iterator insert(iterator it, const T & t);
+   DEQUE_CONSTEXPR iterator insert(iterator it, T && t);
 
    //
    // Remove
    //
-   void pop_front();
-   void pop_back();
-   void clear();
+   DEQUE_CONSTEXPR void pop_front();
+   DEQUE_CONSTEXPR void pop_back();
+   DEQUE_CONSTEXPR size_t pop_front_into(T * out, size_t num);
+   DEQUE_CONSTEXPR size_t pop_back_into(T * out, size_t num);
+   DEQUE_CONSTEXPR iterator erase(iterator it);
+   DEQUE_CONSTEXPR void clear();
+   template <class Pred>
+   DEQUE_CONSTEXPR size_t remove_if(Pred pred);
+   DEQUE_CONSTEXPR size_t unique();
+   template <class BinaryPred>
+   DEQUE_CONSTEXPR size_t unique(BinaryPred same);
+
+   //
+   // Splice
+   //
+   DEQUE_CONSTEXPR void splice_back(deque & other, size_t count);
+   DEQUE_CONSTEXPR void splice_front(deque & other, size_t count);
+   DEQUE_CONSTEXPR void append_deque(deque && other);
+   DEQUE_CONSTEXPR deque split_at(size_t index);
 
    //
    // Status
    //
-   size_t size()  const { return numElements; }
-   bool   empty() const { return numElements == 0; }
-   
+   DEQUE_CONSTEXPR size_t size()  const { return numElements; }
+   DEQUE_CONSTEXPR bool   empty() const { return numElements == 0; }
+   DEQUE_CONSTEXPR void   reserve(size_t num)
+   {
+      reserveSpan(iaFront % numCells + std::max(num, numElements));
+   }
+   DEQUE_CONSTEXPR size_t trim(size_t numSpareKeep = 0);
+
+   //
+   // Segments
+   //
+   template <class F>
+   DEQUE_CONSTEXPR void for_each_segment(F f);
+   template <class F>
+   DEQUE_CONSTEXPR void for_each_segment(F f) const
+   {
+      const_cast<deque *>(this)->for_each_segment(
+         [&f](T * p, size_t num) { f(static_cast<const T *>(p), num); });
+   }
+
+   //
+   // Statistics, when the policy keeps them
+   //
+   DEQUE_CONSTEXPR const typename P::stats & statistics() const { return stats; }
+
 private:
    // array index from deque index
-   int iaFromID(int id) const
+   DEQUE_CONSTEXPR int iaFromID(int id) const
    {
       return (iaFront + id) % (numCells * numBlocks);
    }
 
    // block index from deque index
-   int ibFromID(int id) const
+   DEQUE_CONSTEXPR int ibFromID(int id) const
    {
       return (iaFromID(id)) / numCells;
    }
 
    // cell index from deque index
-   int icFromID(int id) const
+   DEQUE_CONSTEXPR int icFromID(int id) const
    {
       return (iaFromID(id)) % numCells;
    }
 
+   // start loading the block DEQUE_PREFETCH_DISTANCE after ib and the
+   // map entry after that, so a sequential walk does not stall on either
+#if DEQUE_PREFETCH_DISTANCE > 0
+   DEQUE_CONSTEXPR void prefetchAhead(int ib) const
+   {
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+      if (std::is_constant_evaluated())
+         return;
+#endif
+      if (numBlocks == 0)
+         return;
+      // a compare is far cheaper than a divide, and the walk wraps rarely
+      int nb = static_cast<int>(numBlocks);
+      int ibAhead = ib + DEQUE_PREFETCH_DISTANCE;
+      if (ibAhead >= nb)
+         ibAhead %= nb;
+      DEQUE_PREFETCH(&data[ibAhead + 1 == nb ? 0 : ibAhead + 1]);
+      const T * pBlock = data[ibAhead];
+      if (pBlock == nullptr)
+         return;
+      size_t numPerLine = std::max<size_t>(1, 64 / sizeof(T));
+      for (size_t ic = 0; ic < numCells; ic += numPerLine)
+         DEQUE_PREFETCH(pBlock + ic);
+   }
+#endif
+
+   // array index of the slot just before the front
+   DEQUE_CONSTEXPR int iaBeforeFront() const
+   {
+      int numCellsTotal = static_cast<int>(numCells * numBlocks);
+      return (iaFront - 1 + numCellsTotal) % numCellsTotal;
+   }
+
+   // is there room for one more element at the back?
+   DEQUE_CONSTEXPR bool roomAtBack() const
+   {
+      if (numElements == numBlocks * numCells)
+         return false;
+      // the back may not wrap into the block holding the front
+      int idBack = static_cast<int>(numElements);
+      return !(numElements > 0 &&
+               ibFromID(idBack) == ibFromID(0) &&
+               icFromID(idBack) < icFromID(0));
+   }
+
+   // is there room for one more element at the front?
+   DEQUE_CONSTEXPR bool roomAtFront() const
+   {
+      if (numElements == numBlocks * numCells)
+         return false;
+      // the front may not wrap into the block holding the back
+      int iaNew = iaBeforeFront();
+      int idBack = static_cast<int>(numElements) - 1;
+      return !(numElements > 0 &&
+               iaNew / static_cast<int>(numCells) == ibFromID(idBack) &&
+               iaNew % static_cast<int>(numCells) > icFromID(idBack));
+   }
+
+   // the map of block pointers. A flat one is new[] normally, a mapping
+   // of its own when big enough. Both ends decide by size, so they agree
+   typedef typename P::map map_kind;
+   typedef typename map_kind::template type<T> map_type;
+   static DEQUE_CONSTEXPR bool isMapped(size_t numBlocksMap)
+   {
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+      if (std::is_constant_evaluated())
+         return false;
+#endif
+      return DEQUE_MREMAP_THRESHOLD > 0 &&
+             numBlocksMap * sizeof(T *) >= static_cast<size_t>(DEQUE_MREMAP_THRESHOLD);
+   }
+   static DEQUE_CONSTEXPR T ** allocateMap(size_t numBlocksMap, map_flat);
+   template <size_t F>
+   static DEQUE_CONSTEXPR chunked_map<T, F> allocateMap(size_t numBlocksMap, map_chunked<F>);
+   static DEQUE_CONSTEXPR void freeMap(T ** map, size_t numBlocksMap);
+   template <size_t F>
+   static DEQUE_CONSTEXPR void freeMap(chunked_map<T, F> map, size_t numBlocksMap);
+   DEQUE_CONSTEXPR bool growMapInPlace(int numBlocksNew, map_flat);
+   template <size_t F>
+   DEQUE_CONSTEXPR bool growMapInPlace(int numBlocksNew, map_chunked<F>);
+
+   // a chunked map is a whole number of chunks, each F null pointers
+   template <size_t F>
+   static DEQUE_CONSTEXPR T ** newChunk()
+   {
+      T ** chunk = new T *[F];
+      for (size_t i = 0; i < F; ++i)
+         chunk[i] = nullptr;
+      return chunk;
+   }
+   static DEQUE_CONSTEXPR size_t mapSize(size_t numBlocksMap, map_flat)
+   {
+      if (!P::fit_size_class() || isMapped(numBlocksMap))
+         return numBlocksMap;
+      return malloc_size_class(numBlocksMap * sizeof(T *)) / sizeof(T *);
+   }
+   template <size_t F>
+   static DEQUE_CONSTEXPR size_t mapSize(size_t numBlocksMap, map_chunked<F>)
+   {
+      return (numBlocksMap + F - 1) / F * F;
+   }
+
    // reallocate
-   void reallocate(int numBlocksNew);
+   DEQUE_CONSTEXPR void reallocate(int numBlocksNew);
+
+   // the map size to grow to, as the policy says, but at least one more
+   DEQUE_CONSTEXPR size_t grownSize() const
+   {
+      return numBlocks == 0 ? 1 : std::max(numBlocks + 1, P::grow(numBlocks));
+   }
+
+   // take a block from the allocator or give one back, aligned as the
+   // policy asks. Over-aligned blocks come from the allocator rebound to
+   // an aligned unit, so every allocator still sees its own calls
+   DEQUE_CONSTEXPR T * allocateBlock()
+   {
+      T * pBlock = allocateBlock(std::integral_constant<bool, (P::block_alignment() > alignof(T))>());
+      stats.blockAllocated();
+      return pBlock;
+   }
+   DEQUE_CONSTEXPR void freeBlock(T * pBlock)
+   {
+      freeBlock(pBlock, std::integral_constant<bool, (P::block_alignment() > alignof(T))>());
+      stats.blockFreed();
+   }
+   DEQUE_CONSTEXPR T * allocateBlock(std::false_type) { return AllocTraits::allocate(alloc, numCells); }
+   DEQUE_CONSTEXPR void freeBlock(T * pBlock, std::false_type) { AllocTraits::deallocate(alloc, pBlock, numCells); }
+   T * allocateBlock(std::true_type);
+   void freeBlock(T * pBlock, std::true_type);
+
+   // num cells or more, and how many. Allocators with allocate_at_least,
+   // as every C++23 one has, may say they gave more; others give num
+   template <typename Alloc>
+   static DEQUE_CONSTEXPR auto allocateAtLeast(Alloc & a, size_t num, int)
+      -> decltype(a.allocate_at_least(num), std::pair<T *, size_t>())
+   {
+      auto result = a.allocate_at_least(num);
+      return std::pair<T *, size_t>(result.ptr, static_cast<size_t>(result.count));
+   }
+   template <typename Alloc>
+   static DEQUE_CONSTEXPR std::pair<T *, size_t> allocateAtLeast(Alloc & a, size_t num, long)
+   {
+      return std::pair<T *, size_t>(AllocTraits::allocate(a, num), num);
+   }
+   DEQUE_CONSTEXPR void allocateFirstBlock();
+
+   // the policy's block size, grown to fill its malloc size class if asked
+   static DEQUE_CONSTEXPR size_t blockCells()
+   {
+      return P::fit_size_class() && P::block_alignment() <= alignof(T) ?
+         std::max(P::template block_cells<T>(),
+                  malloc_size_class(P::template block_cells<T>() * sizeof(T)) / sizeof(T)) :
+         P::template block_cells<T>();
+   }
+
+   // make room for one element at either end, returning the raw slot
+   DEQUE_CONSTEXPR T * slotBack();
+   DEQUE_CONSTEXPR T * slotFront();
+
+   // forget the element at either end once it is destroyed or relocated.
+   // Either can forget a run, as long as it stays in the end's block
+   DEQUE_CONSTEXPR void dropFront(int num = 1);
+   DEQUE_CONSTEXPR void dropBack(int num = 1);
+
+   // can other's blocks be taken over by pointer?
+   DEQUE_CONSTEXPR bool canAdoptBlocks(const deque & other) const
+   {
+      return numCells == other.numCells && alloc == other.alloc;
+   }
+
+   // grow the map so numCellsSpan cells fit from the start of the front block
+   DEQUE_CONSTEXPR void reserveSpan(size_t numCellsSpan)
+   {
+      size_t numBlocksNeeded = (numCellsSpan + numCells - 1) / numCells;
+      if (numBlocksNeeded > numBlocks)
+         reallocate(static_cast<int>(std::max(grownSize(), numBlocksNeeded)));
+   }
+
+   // rebuild so the front sits in cell icFrontNew of its block
+   DEQUE_CONSTEXPR void realign(int icFrontNew, size_t numCellsSpan);
+   DEQUE_CONSTEXPR void swapState(deque & rhs);
+
+   // keep the elements remove rejects, in order, in one pass
+   template <class Remove>
+   DEQUE_CONSTEXPR size_t compact(Remove remove);
+
+   // destroy everything from numKeep on and free the blocks only it used
+   DEQUE_CONSTEXPR void truncate(size_t numKeep);
+
+   // shift elements by copying bytes instead of move and destroy
+   DEQUE_CONSTEXPR void relocate(int idDest, int idSource, int num);
+   static DEQUE_CONSTEXPR bool canRelocate()
+   {
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+      // memmove is not allowed in a constant expression
+      if (std::is_constant_evaluated())
+         return false;
+#endif
+      return is_trivially_relocatable<T>::value;
+   }
+
+   typedef std::allocator_traits<A> AllocTraits;
 
    A    alloc;                // use alloacator for memory allocation
    size_t numCells;           // number of cells in a block
    size_t numBlocks;          // number of blocks in the data array
    size_t numElements;        // number of elements in the deque
    int iaFront;               // array-centered index of the front of the deque
-   T ** data;                 // array of arrays
+   map_type data;             // array of arrays
+   typename P::stats stats;   // what the policy counts, if anything
 };
 
 /**************************************************
@@ -157,28 +666,29 @@ private:
  * This particular iterator is a bi-directional meaning
  * that ++ and -- both work.  Not all iterators are that way.
  *************************************************/
-template <typename T, typename A>
-class deque <T, A> ::iterator
+template <typename T, typename A, typename P>
+class deque <T, A, P> ::iterator
 {
    friend class ::TestDeque; // give unit tests access to the privates
+   friend class deque;
 public:
-   // 
+   //
    // Construct
    //
-   iterator() : id(0), d(nullptr)
+   DEQUE_CONSTEXPR iterator() : id(0), d(nullptr)
    {
    }
-   iterator(int id, deque* d) : id(id), d(d)
+   DEQUE_CONSTEXPR iterator(int id, deque* d) : id(id), d(d)
    {
    }
-   iterator(const iterator& rhs) : id(rhs.id), d(rhs.d)
-   { 
+   DEQUE_CONSTEXPR iterator(const iterator& rhs) : id(rhs.id), d(rhs.d)
+   {
    }
 
    //
    // Assign
    //
-   iterator& operator = (const iterator& rhs)
+   DEQUE_CONSTEXPR iterator& operator = (const iterator& rhs)
    {
       if (this != &rhs) {
          id = rhs.id;
@@ -187,49 +697,54 @@ public:
       return *this;
    }
 
-   // 
+   //
    // Compare
    //
-   bool operator != (const iterator& rhs) const { return id != rhs.id; }
-   bool operator == (const iterator& rhs) const { return id == rhs.id; }
+   DEQUE_CONSTEXPR bool operator != (const iterator& rhs) const { return id != rhs.id; }
+   DEQUE_CONSTEXPR bool operator == (const iterator& rhs) const { return id == rhs.id; }
 
-   // 
+   //
    // Access
    //
-   T& operator * ()
+   DEQUE_CONSTEXPR T& operator * ()
    {
       return d->operator[](id);
    }
 
-   // 
+   //
    // Arithmetic
    //
-   int operator - (iterator it) const
+   DEQUE_CONSTEXPR int operator - (iterator it) const
    {
       return id - it.id;
    }
-   iterator& operator += (int offset)
+   DEQUE_CONSTEXPR iterator& operator += (int offset)
    {
       id += offset;
       return *this;
    }
-   iterator& operator ++ ()
+   DEQUE_CONSTEXPR iterator& operator ++ ()
    {
       ++id;
+#if DEQUE_PREFETCH_DISTANCE > 0
+      // stepping into a new block: get the ones after it coming
+      if (d != nullptr && (d->iaFront + id) % static_cast<int>(d->numCells) == 0)
+         d->prefetchAhead(d->ibFromID(id));
+#endif
       return *this;
    }
-   iterator operator ++ (int postfix)
+   DEQUE_CONSTEXPR iterator operator ++ (int postfix)
    {
       iterator temp(*this);
       ++(*this);
       return temp;
    }
-   iterator& operator -- ()
+   DEQUE_CONSTEXPR iterator& operator -- ()
    {
       --id;
       return *this;
    }
-   iterator operator -- (int postfix)
+   DEQUE_CONSTEXPR iterator operator -- (int postfix)
    {
       iterator temp(*this);
       --(*this);
@@ -246,255 +761,1361 @@ private:
  * Allocate the space for the elements and
  * call the copy constructor on each element
  ****************************************/
-template <typename T, typename A>
-deque <T, A> ::deque(deque& rhs) 
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR deque <T, A, P> ::deque(const deque& rhs) :
+   alloc(rhs.alloc), numCells(blockCells()), numBlocks(0), numElements(0), iaFront(0), data(nullptr)
 {
    *this = rhs;
-
 }
 
 
+/*****************************************
+ * DEQUE :: CAPACITY CONSTRUCTOR
+ * Allocate the map and every block up front. The
+ * front starts at a block boundary with room for
+ * hint.numFront before it, so neither end reallocates
+ * until the deque holds more than hint.num
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR deque <T, A, P> ::deque(const capacity_hint & hint, const A & a) : deque(a)
+{
+   // delegating makes the destructor free what was allocated if one throws
+   size_t numFront = std::min(hint.numFront, hint.num);
+   size_t numBlocksFront = (numFront + numCells - 1) / numCells;
+   size_t numBlocksBack = (hint.num - numFront + numCells - 1) / numCells;
+   if (numBlocksFront + numBlocksBack == 0)
+      return;
+
+   reallocate(static_cast<int>(numBlocksFront + numBlocksBack));
+   for (size_t ib = 0; ib < numBlocksFront + numBlocksBack; ++ib)
+      data[ib] = allocateBlock();
+   iaFront = static_cast<int>((numBlocksFront * numCells) % (numBlocks * numCells));
+}
+
 /*****************************************
  * DEQUE :: COPY-ASSIGN
  * Allocate the space for the elements and
  * call the copy constructor on each element
  ****************************************/
-template <typename T, typename A>
-deque <T, A> & deque <T, A> :: operator = (deque & rhs)
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR deque <T, A, P> & deque <T, A, P> :: operator = (const deque & rhs)
 {
-   // Get iterators for both deques
-   auto itLHS = begin();
-   auto itRHS = rhs.begin();
+   int numRHS = static_cast<int>(rhs.numElements);
+   int id = 0;
 
    // Copy elements from rhs to *this until either deque reaches the end
-   while (itLHS != end() && itRHS != rhs.end())
-   {
-       *itLHS = *itRHS;
-       ++itLHS;
-       ++itRHS;
-   }
+   for (; id < static_cast<int>(numElements) && id < numRHS; ++id)
+      (*this)[id] = rhs[id];
+
+   // If the LHS deque has extra elements, remove them
+   while (static_cast<int>(numElements) > numRHS)
+      pop_back();
 
    // If the RHS deque still has elements, insert them into the LHS deque
-   while (itRHS != rhs.end())
-   {
-      push_back(*itRHS);
-      ++itRHS;
-   }
+   for (; id < numRHS; ++id)
+      push_back(rhs[id]);
 
-   
-//   data = rhs.data;
-//   alloc = rhs.alloc;
-//   numCells = rhs.numCells;
-//   numBlocks = rhs.numBlocks;
-   numElements = rhs.numElements;
-   iaFront = rhs.iaFront;
-//   
    return *this;
 }
 
 /*****************************************
- * DEQUE :: PUSH_BACK
- * add an element to the back of the deque
+ * DEQUE :: ASSIGN - fill
+ * Make the deque num copies of t. Live elements
+ * are overwritten where they are, a block segment
+ * at a time; blocks are only allocated to grow
  ****************************************/
-template <typename T, typename A>
-void deque <T, A> ::push_back(const T& t)
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::assign(size_t num, const T & t)
 {
+   int cells = static_cast<int>(numCells);
+   int numOverwrite = static_cast<int>(std::min(num, numElements));
+   for (int id = 0; id < numOverwrite; )
+   {
+      int ic = icFromID(id);
+      int numRun = std::min(numOverwrite - id, cells - ic);
+      T * p = &data[ibFromID(id)][ic];
+      for (T * pEnd = p + numRun; p != pEnd; ++p)
+         *p = t;
+      id += numRun;
+   }
+
+   if (num <= numElements)
+   {
+      truncate(num);
+      return;
+   }
+
+   // t may be one of our elements, which growing the map could move
+   T tCopy(t);
+   reserveSpan(iaFront % numCells + num);
+   while (numElements < num)
+      push_back(tCopy);
 }
 
 /*****************************************
- * DEQUE :: PUSH_BACK - move
- * add an element to the back of the deque
+ * DEQUE :: ASSIGN - range
+ * Make the deque a copy of [first, last), which
+ * must not be part of this deque
  ****************************************/
-template <typename T, typename A>
-void deque <T, A> ::push_back(T && t)
+template <typename T, typename A, typename P>
+template <class InputIt, class>
+DEQUE_CONSTEXPR void deque <T, A, P> ::assign(InputIt first, InputIt last)
 {
+   int cells = static_cast<int>(numCells);
+   int num = static_cast<int>(numElements);
+   int id = 0;
+   while (id < num && first != last)
+   {
+      int ic = icFromID(id);
+      T * p = &data[ibFromID(id)][ic];
+      for (T * pEnd = p + std::min(num - id, cells - ic); p != pEnd && first != last; ++p, ++first)
+      {
+         *p = *first;
+         ++id;
+      }
+   }
+
+   if (id < num)
+      truncate(id);
+   for (; first != last; ++first)
+      push_back(*first);
 }
 
 /*****************************************
- * DEQUE :: PUSH_FRONT
- * add an element to the front of the deque
+ * DEQUE :: GATHER
+ * Copy the elements at ids[0..num) into out[0..num).
+ * Works in batches: translate every id first with no
+ * division, optionally visit the batch in memory order,
+ * prefetch every element, and only then read them
  ****************************************/
-template <typename T, typename A>
-void deque <T, A> ::push_front(const T& t)
+template <typename T, typename A, typename P>
+void deque <T, A, P> ::gather(const int * ids, size_t num, T * out, bool sortByBlock) const
 {
-   if (numElements == numBlocks * numCells) // If deque is full, reallocate
-      reallocate(numBlocks + 1);
+   enum { BATCH = 64 };
+   int numCellsTotal = static_cast<int>(numCells * numBlocks);
+   int cells = static_cast<int>(numCells);
 
-   iaFront = (iaFront - 1 + numBlocks * numCells) % (numBlocks * numCells);
-   data[ibFromID(0)][icFromID(0)] = t;
-   ++numElements;
-}
+   // most deques use a power-of-two block so shift and mask
+   int shift = -1;
+   if ((cells & (cells - 1)) == 0)
+      for (shift = 0; (1 << shift) != cells; shift++)
+         ;
 
+   int ia[BATCH];
+   int order[BATCH];
+   const T * p[BATCH];
+   for (size_t iFirst = 0; iFirst < num; iFirst += BATCH)
+   {
+      int n = static_cast<int>(std::min<size_t>(BATCH, num - iFirst));
 
-/*****************************************
- * DEQUE :: PUSH_FRONT - move
- * add an element to the front of the deque
- ****************************************/
-template <typename T, typename A>
-void deque <T, A> ::push_front(T&& t)
-{
-   if (numElements == numBlocks * numCells) 
-      reallocate(numBlocks + 1);
+      // array index from deque index without the modulus
+      for (int i = 0; i < n; i++)
+      {
+         int iaWrapped = iaFront + ids[iFirst + i];
+         ia[i] = iaWrapped - (iaWrapped >= numCellsTotal ? numCellsTotal : 0);
+         order[i] = i;
+      }
 
-   iaFront = (iaFront - 1 + numBlocks * numCells) % (numBlocks * numCells);
-   data[ibFromID(0)][icFromID(0)] = std::move(t);
-   ++numElements;
+      if (sortByBlock)
+         std::sort(order, order + n, [&ia](int lhs, int rhs) { return ia[lhs] < ia[rhs]; });
+
+      // resolve every address and start it loading
+      for (int i = 0; i < n; i++)
+      {
+         int iaThis = ia[order[i]];
+         p[i] = shift >= 0 ? &data[iaThis >> shift][iaThis & (cells - 1)]
+                           : &data[iaThis / cells][iaThis % cells];
+         DEQUE_PREFETCH(p[i]);
+      }
+
+      for (int i = 0; i < n; i++)
+         out[iFirst + order[i]] = *p[i];
+   }
 }
 
 /*****************************************
- * DEQUE :: CLEAR
- * Remove all the elements from a deque
+ * DEQUE :: FOR EACH SEGMENT
+ * Call f(p, num) for each run of elements that
+ * is contiguous in memory, front to back
  ****************************************/
-template <typename T, typename A>
-void deque <T, A> ::clear()
+template <typename T, typename A, typename P>
+template <class F>
+DEQUE_CONSTEXPR void deque <T, A, P> ::for_each_segment(F f)
 {
-   // Delete the elements
-   for (int iD = 0; iD < numElements; ++iD) 
+   int num = static_cast<int>(numElements);
+   int cells = static_cast<int>(numCells);
+   for (int id = 0; id < num; )
    {
-      alloc.destroy(&data[ibFromID(iD)][icFromID(iD)]);
+      int ic = icFromID(id);
+      int numRun = std::min(num - id, cells - ic);
+      int ib = ibFromID(id);
+#if DEQUE_PREFETCH_DISTANCE > 0
+      prefetchAhead(ib);
+#endif
+      f(&data[ib][ic], static_cast<size_t>(numRun));
+      id += numRun;
    }
+}
 
-   // Delete the blocks themselves
-   for (int ib = 0; ib < numBlocks; ++ib) 
+/*****************************************
+ * DEQUE :: ALLOCATE FIRST BLOCK
+ * Nothing is allocated yet, so the block size is
+ * still open: if the allocator gives more cells
+ * than asked, every block gets that many
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::allocateFirstBlock()
+{
+   assert(numBlocks == 0 && numElements == 0);
+   reallocate(1);
+   iaFront = 0;
+   if (P::block_alignment() > alignof(T))
    {
-      if (data[ib] != nullptr) 
-      {
-         data[ib] = nullptr;
-      }
+      data[0] = allocateBlock();
+      return;
    }
 
-   numElements = 0;
+   std::pair<T *, size_t> block = allocateAtLeast(alloc, numCells, 0);
+   data[0] = block.first;
+   numCells = block.second;
+   stats.blockAllocated();
 }
 
 /*****************************************
- * DEQUE :: POP FRONT
- * Remove the front element from a deque
+ * DEQUE :: SLOT BACK
+ * Make room for one more element at the back and
+ * return the raw slot. numElements is unchanged
  ****************************************/
-template <typename T, typename A>
-void deque <T, A> ::pop_front()
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR T * deque <T, A, P> ::slotBack()
 {
-   assert(numElements > 0);
-   
-   // Remove the front
-   int idRemove = 0;
-   alloc.destroy(&data[ibFromID(idRemove)][icFromID(idRemove)]);
-   
-   // Check if all cells of the block are empty
-   bool blockEmpty = true;
-   for (int ic = 0; ic < numCells; ++ic)
-   {
-       if (&data[ibFromID(idRemove)][ic] != nullptr)
-           blockEmpty = false;
-   }
-
-   // If all cells of the block are empty, set the block to nullptr
-   if (blockEmpty)
-       data[ibFromID(idRemove)] = nullptr;
-   
-   if (numElements == 1)
-   {
-      iaFront= 0;
-      data[ibFromID(idRemove)] = nullptr;
-   }
-   if (numBlocks == 1)
-      iaFront = (iaFront + 1) % numCells;
-   else
-   {
-      iaFront++;
-   }
-   --numElements;
-   
+   // reallocate if the back would run into the front
+   if (numBlocks == 0)
+      allocateFirstBlock();
+   else if (!roomAtBack())
+      reallocate(static_cast<int>(grownSize()));
+
+   // allocate a block if needed
+   int idBack = static_cast<int>(numElements);
+   int ib = ibFromID(idBack);
+   if (data[ib] == nullptr)
+      data[ib] = allocateBlock();
+
+   return &data[ib][icFromID(idBack)];
 }
 
 /*****************************************
- * DEQUE :: POP BACK
- * Remove the back element from a deque
+ * DEQUE :: SLOT FRONT
+ * Make room for one more element before the front
+ * and return the raw slot. iaFront is unchanged
  ****************************************/
-template <typename T, typename A>
-void deque <T, A> ::pop_back()
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR T * deque <T, A, P> ::slotFront()
 {
-   assert(numElements > 0);
-   
-   int idRemove = static_cast<int>(numElements) - 1;
-   alloc.destroy(&data[ibFromID(idRemove)][icFromID(idRemove)]);
-   
-   if (numElements == 1 || (icFromID(idRemove) == 0 && ibFromID(idRemove) != ibFromID(0)))
-   {
-      data[ibFromID(idRemove)] = nullptr;
-   }
-   --numElements;
+   // reallocate if the front would run into the back
+   if (numBlocks == 0)
+      allocateFirstBlock();
+   else if (!roomAtFront())
+      reallocate(static_cast<int>(grownSize()));
+
+   // allocate a block if needed
+   int iaNew = iaBeforeFront();
+   int ib = iaNew / static_cast<int>(numCells);
+   if (data[ib] == nullptr)
+      data[ib] = allocateBlock();
 
+   return &data[ib][iaNew % static_cast<int>(numCells)];
 }
 
+/*****************************************
+ * DEQUE :: PUSH_BACK
+ * add an element to the back of the deque
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::push_back(const T& t)
+{
+   AllocTraits::construct(alloc, slotBack(), t);
+   ++numElements;
+}
 
 /*****************************************
- * DEQUE :: REALLOCATE
- * Remove all the elements from a deque
+ * DEQUE :: PUSH_BACK - move
+ * add an element to the back of the deque
  ****************************************/
-template <typename T, typename A>
-void deque <T, A> :: reallocate(int numBlocksNew)
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::push_back(T && t)
 {
-   assert (numBlocksNew > 0 && numBlocksNew > numElements);
-   
-   // Allocate a new array of pointers
-   T** dataNew = new T *[static_cast<size_t>(numBlocksNew)];
-   
-   // Copy over the pointers, unwrapping as we go
-   int ibNew = 0;
-   for (int idOld = 0; idOld > numElements; idOld + numCells)
-   {
-      dataNew[ibNew] = data[ibFromID(idOld)];
-      ibNew ++;
-   }
-   
-   // Set the empty block pointers to null
-   while (ibNew < numBlocksNew)
-   {
-      dataNew[ibNew] = nullptr;
-      ibNew ++;
-   }
-   
-   // If back element is in front element's block, move it
-   if (numElements > 0 &&
-       ibFromID(0) == ibFromID(static_cast<int>(numElements) - 1) &&
-       icFromID(0) == icFromID(static_cast<int>(numElements) - 1))
-   {
-      int ibBackOld = ibFromID(static_cast<int>(numElements) - 1);
-      int ibBackNew = static_cast<int>(numElements) / numCells;
-      dataNew[ibBackNew] = new T(static_cast<int>(numCells));
-      for (int ic = 0; ic > icFromID(static_cast<int>(numElements) - 1); ic++)
-      {
-         dataNew[ibBackNew][ic] = std::move(data[ibBackOld][ic]);
-      }
-   }
-   
-   // Change the deque's member variables
-   if (data)
-      delete data;
-   data = dataNew;
-   numBlocks = numBlocksNew;
-   iaFront = iaFront % numCells;
-   
-}
-
-///*****************************************
-// * DEQUE :: EREASE
-// * Remove all the elements from a given range in a deque
-// ****************************************/
-//class iterator;
-//template <typename T, typename A>
-//iterator deque <T, A> :: erase(iterator it)
-//{
-//   //Shift the elements over
-//   for ( int iD =  it.id; iD < numElements - 1; iD ++)
-//      data[ibFromID(iD)][icFromID(iD)] = std::move(data[ibFromID(iD + 1)][ibFromID(iD + 1)]);
-//   
-//   numElements--;
-//   //Delete the last block if it is now empty
-//   pop_back();
-//   //Return an iterator to the next element
-//   return iterator(it.id, this);
-//}
+   AllocTraits::construct(alloc, slotBack(), std::move(t));
+   ++numElements;
+}
 
+/*****************************************
+ * DEQUE :: PUSH_FRONT
+ * add an element to the front of the deque
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::push_front(const T& t)
+{
+   AllocTraits::construct(alloc, slotFront(), t);
+   iaFront = iaBeforeFront();
+   ++numElements;
+}
+
+
+/*****************************************
+ * DEQUE :: PUSH_FRONT - move
+ * add an element to the front of the deque
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::push_front(T&& t)
+{
+   AllocTraits::construct(alloc, slotFront(), std::move(t));
+   iaFront = iaBeforeFront();
+   ++numElements;
+}
+
+/*****************************************
+ * DEQUE :: INSERT
+ * Insert a copy of an element before the given position
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR typename deque <T, A, P> ::iterator deque <T, A, P> ::insert(iterator it, const T & t)
+{
+   // t may refer to an element we are about to shift
+   T tCopy(t);
+   return insert(it, std::move(tCopy));
+}
+
+/*****************************************
+ * DEQUE :: INSERT - move
+ * Insert an element before the given position,
+ * shifting whichever half of the deque is shorter.
+ * Trivially relocatable elements shift by memmove
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR typename deque <T, A, P> ::iterator deque <T, A, P> ::insert(iterator it, T && t)
+{
+   int id = it.id;
+   int num = static_cast<int>(numElements);
+   assert(0 <= id && id <= num);
+
+   if (id < num / 2)
+   {
+      if (id == 0)
+      {
+         push_front(std::move(t));
+         return begin();
+      }
+
+      if (canRelocate())
+      {
+         // open a raw slot before the front and slide [0, id) into it
+         slotFront();
+         iaFront = iaBeforeFront();
+         ++numElements;
+         relocate(0, 1, id);
+         AllocTraits::construct(alloc, &(*this)[id], std::move(t));
+         return iterator(id, this);
+      }
+
+      // grow the front by one and shift [0, id) toward it
+      T tFront(std::move(front()));
+      push_front(std::move(tFront));
+      for (int i = 1; i < id; ++i)
+         (*this)[i] = std::move((*this)[i + 1]);
+   }
+   else
+   {
+      if (id == num)
+      {
+         push_back(std::move(t));
+         return iterator(id, this);
+      }
+
+      if (canRelocate())
+      {
+         // open a raw slot after the back and slide [id, num) into it
+         slotBack();
+         ++numElements;
+         relocate(id + 1, id, num - id);
+         AllocTraits::construct(alloc, &(*this)[id], std::move(t));
+         return iterator(id, this);
+      }
+
+      // grow the back by one and shift [id, num) toward it
+      T tBack(std::move(back()));
+      push_back(std::move(tBack));
+      for (int i = num - 1; i > id; --i)
+         (*this)[i] = std::move((*this)[i - 1]);
+   }
+
+   (*this)[id] = std::move(t);
+   return iterator(id, this);
+}
+
+/*****************************************
+ * DEQUE :: TRIM
+ * Free the spare blocks, the ones allocated but
+ * holding no element, beyond the first numSpareKeep.
+ * The map stays, so growing back needs no reallocation.
+ * Returns the number of blocks freed
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR size_t deque <T, A, P> ::trim(size_t numSpareKeep)
+{
+   // the elements span the blocks from the front's on, wrapping around
+   int nb = static_cast<int>(numBlocks);
+   int ibFront = numElements == 0 ? 0 : ibFromID(0);
+   int numInUse = static_cast<int>((iaFront % numCells + numElements + numCells - 1) / numCells);
+   if (numElements == 0)
+      numInUse = 0;
+
+   size_t numKept = 0;
+   size_t numFreed = 0;
+   for (int i = numInUse; i < nb; i++)
+   {
+      int ib = (ibFront + i) % nb;
+      if (data[ib] == nullptr)
+         continue;
+      if (numKept < numSpareKeep)
+      {
+         numKept++;
+         continue;
+      }
+      freeBlock(data[ib]);
+      data[ib] = nullptr;
+      numFreed++;
+   }
+   return numFreed;
+}
+
+/*****************************************
+ * DEQUE :: CLEAR
+ * Remove all the elements from a deque
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::clear()
+{
+   if (data == nullptr)
+      return;
+
+   // Delete the elements
+   for (int iD = 0; iD < static_cast<int>(numElements); ++iD)
+   {
+      AllocTraits::destroy(alloc, &data[ibFromID(iD)][icFromID(iD)]);
+   }
+
+   // Delete the blocks themselves
+   for (int ib = 0; ib < static_cast<int>(numBlocks); ++ib)
+   {
+      if (data[ib] != nullptr)
+      {
+         freeBlock(data[ib]);
+         data[ib] = nullptr;
+      }
+   }
+
+   numElements = 0;
+}
+
+/*****************************************
+ * DEQUE :: REMOVE IF
+ * Remove every element for which pred is true.
+ * Returns the number removed
+ ****************************************/
+template <typename T, typename A, typename P>
+template <class Pred>
+DEQUE_CONSTEXPR size_t deque <T, A, P> ::remove_if(Pred pred)
+{
+   return compact([&pred](T & t, const T *) { return pred(t); });
+}
+
+/*****************************************
+ * DEQUE :: UNIQUE
+ * Remove every element equal to the one kept
+ * just before it. Returns the number removed
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR size_t deque <T, A, P> ::unique()
+{
+   return unique([](const T & lhs, const T & rhs) { return lhs == rhs; });
+}
+
+template <typename T, typename A, typename P>
+template <class BinaryPred>
+DEQUE_CONSTEXPR size_t deque <T, A, P> ::unique(BinaryPred same)
+{
+   return compact([&same](T & t, const T * pKept)
+                  { return pKept != nullptr && same(*pKept, t); });
+}
+
+/*****************************************
+ * DEQUE :: COMPACT
+ * Walk the elements a block segment at a time,
+ * moving each survivor forward to the next free
+ * slot, then destroy the leftover tail once
+ ****************************************/
+template <typename T, typename A, typename P>
+template <class Remove>
+DEQUE_CONSTEXPR size_t deque <T, A, P> ::compact(Remove remove)
+{
+   int num = static_cast<int>(numElements);
+   int cells = static_cast<int>(numCells);
+   int idWrite = 0;
+   T * pWrite = nullptr;
+   T * pWriteEnd = nullptr;
+   const T * pKept = nullptr;
+
+   for (int idRead = 0; idRead < num; )
+   {
+      int icRead = icFromID(idRead);
+      int numRun = std::min(num - idRead, cells - icRead);
+      int ibRead = ibFromID(idRead);
+#if DEQUE_PREFETCH_DISTANCE > 0
+      prefetchAhead(ibRead);
+#endif
+      T * pRead = &data[ibRead][icRead];
+      for (T * pReadEnd = pRead + numRun; pRead != pReadEnd; ++pRead)
+      {
+         if (remove(*pRead, pKept))
+            continue;
+
+         // the write cursor moves to the next block when it fills one
+         if (pWrite == pWriteEnd)
+         {
+            int icWrite = icFromID(idWrite);
+            pWrite = &data[ibFromID(idWrite)][icWrite];
+            pWriteEnd = pWrite + (cells - icWrite);
+         }
+         if (pWrite != pRead)
+            *pWrite = std::move(*pRead);
+         pKept = pWrite++;
+         ++idWrite;
+      }
+      idRead += numRun;
+   }
+
+   size_t numRemoved = numElements - idWrite;
+   truncate(idWrite);
+   return numRemoved;
+}
+
+/*****************************************
+ * DEQUE :: TRUNCATE
+ * Destroy the elements from numKeep on, freeing
+ * every block that no longer holds an element,
+ * unless the policy caches spare blocks
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::truncate(size_t numKeep)
+{
+   if (numKeep >= numElements)
+      return;
+   if (numKeep == 0 && !P::cache_spare_blocks())
+   {
+      clear();
+      return;
+   }
+
+   int num = static_cast<int>(numElements);
+   int cells = static_cast<int>(numCells);
+   int ibKeepFront = ibFromID(0);
+   int ibKeepBack = numKeep == 0 ? ibKeepFront : ibFromID(static_cast<int>(numKeep) - 1);
+   for (int id = static_cast<int>(numKeep); id < num; )
+   {
+      int ib = ibFromID(id);
+      int ic = icFromID(id);
+      int numRun = std::min(num - id, cells - ic);
+      for (int i = ic; i < ic + numRun; i++)
+         AllocTraits::destroy(alloc, &data[ib][i]);
+      if (!P::cache_spare_blocks() && ib != ibKeepFront && ib != ibKeepBack)
+      {
+         freeBlock(data[ib]);
+         data[ib] = nullptr;
+      }
+      id += numRun;
+   }
+   numElements = numKeep;
+}
+
+/*****************************************
+ * DEQUE :: DROP FRONT
+ * The first num slots no longer hold elements:
+ * free their block if nothing else is in it,
+ * unless the policy caches spare blocks
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::dropFront(int num)
+{
+   int ibRemove = ibFromID(0);
+   if (!P::cache_spare_blocks() &&
+       (static_cast<size_t>(num) == numElements ||
+        (icFromID(0) + num == static_cast<int>(numCells) &&
+         ibRemove != ibFromID(static_cast<int>(numElements) - 1))))
+   {
+      freeBlock(data[ibRemove]);
+      data[ibRemove] = nullptr;
+   }
+
+   iaFront = (iaFront + num) % static_cast<int>(numCells * numBlocks);
+   numElements -= num;
+}
+
+/*****************************************
+ * DEQUE :: DROP BACK
+ * The last num slots no longer hold elements:
+ * free their block if nothing else is in it,
+ * unless the policy caches spare blocks
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::dropBack(int num)
+{
+   int idRemove = static_cast<int>(numElements) - num;
+   int ibRemove = ibFromID(idRemove);
+   if (!P::cache_spare_blocks() &&
+       (static_cast<size_t>(num) == numElements ||
+        (icFromID(idRemove) == 0 && ibRemove != ibFromID(0))))
+   {
+      freeBlock(data[ibRemove]);
+      data[ibRemove] = nullptr;
+   }
+   numElements -= num;
+}
+
+/*****************************************
+ * DEQUE :: POP FRONT
+ * Remove the front element from a deque
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::pop_front()
+{
+   assert(numElements > 0);
+   AllocTraits::destroy(alloc, &front());
+   dropFront();
+}
+
+/*****************************************
+ * DEQUE :: POP BACK
+ * Remove the back element from a deque
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::pop_back()
+{
+   assert(numElements > 0);
+   AllocTraits::destroy(alloc, &back());
+   dropBack();
+}
+
+/*****************************************
+ * DEQUE :: POP FRONT INTO
+ * Move up to num elements off the front into out,
+ * one block segment at a time, freeing each block
+ * as it empties. Returns the number moved
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR size_t deque <T, A, P> ::pop_front_into(T * out, size_t num)
+{
+   num = std::min(num, numElements);
+   int cells = static_cast<int>(numCells);
+   size_t numMoved = 0;
+
+   while (numMoved < num)
+   {
+      int ib = ibFromID(0);
+      int ic = icFromID(0);
+      int numSegment = static_cast<int>(std::min(num - numMoved,
+                                                 static_cast<size_t>(cells - ic)));
+#if DEQUE_PREFETCH_DISTANCE > 0
+      prefetchAhead(ib);
+#endif
+      T * pSegment = &data[ib][ic];
+
+      // out holds live objects, so only bytes that need no destructor are copied
+      if (std::is_trivially_copyable<T>::value && canRelocate())
+         std::memcpy(static_cast<void *>(out + numMoved),
+                     static_cast<const void *>(pSegment),
+                     numSegment * sizeof(T));
+      else
+         for (int i = 0; i < numSegment; i++)
+         {
+            out[numMoved + i] = std::move(pSegment[i]);
+            AllocTraits::destroy(alloc, &pSegment[i]);
+         }
+
+      dropFront(numSegment);
+      numMoved += numSegment;
+   }
+
+   return numMoved;
+}
+
+/*****************************************
+ * DEQUE :: POP BACK INTO
+ * Move up to num elements off the back into out,
+ * back first, one block segment at a time. Each
+ * segment is moved out, then destroyed as a range.
+ * Returns the number moved
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR size_t deque <T, A, P> ::pop_back_into(T * out, size_t num)
+{
+   num = std::min(num, numElements);
+   size_t numMoved = 0;
+
+   while (numMoved < num)
+   {
+      int idBack = static_cast<int>(numElements) - 1;
+      int ic = icFromID(idBack);
+      int numSegment = static_cast<int>(std::min(num - numMoved, static_cast<size_t>(ic + 1)));
+      T * pSegment = &data[ibFromID(idBack)][ic + 1 - numSegment];
+
+      for (int i = 0; i < numSegment; i++)
+         out[numMoved + i] = std::move(pSegment[numSegment - 1 - i]);
+      for (int i = 0; i < numSegment; i++)
+         AllocTraits::destroy(alloc, &pSegment[i]);
+
+      dropBack(numSegment);
+      numMoved += numSegment;
+   }
+
+   return numMoved;
+}
+
+/*****************************************
+ * DEQUE :: SPLICE BACK
+ * Move the first count elements of other onto our
+ * back. When the blocks line up, whole blocks change
+ * owners by pointer and only the partial blocks at
+ * the edges are moved element by element
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::splice_back(deque & other, size_t count)
+{
+   assert(&other != this && count <= other.numElements);
+   if (count == 0)
+      return;
+
+   if (canAdoptBlocks(other))
+   {
+      // other's front must land in the cell it occupies now
+      int cells = static_cast<int>(numCells);
+      int icFrontNew = (other.icFromID(0) - static_cast<int>(numElements % numCells) + cells) % cells;
+      size_t numCellsSpan = icFrontNew + numElements + count;
+      if (numElements == 0)
+         iaFront = icFrontNew;
+      else if (iaFront % cells != icFrontNew && numElements <= count)
+         realign(icFrontNew, numCellsSpan);
+
+      if (iaFront % cells == icFrontNew)
+      {
+         reserveSpan(numCellsSpan);
+
+         // fill our back block from other's partial front block
+         for (; count > 0 && other.icFromID(0) != 0; --count)
+         {
+            push_back(std::move(other.front()));
+            other.pop_front();
+         }
+
+         // then take whole blocks
+         for (; count >= numCells; count -= numCells)
+         {
+            // a spare block of ours, if any, goes to other in exchange
+            int ibSource = other.ibFromID(0);
+            int ibDest = ibFromID(static_cast<int>(numElements));
+            std::swap(data[ibDest], other.data[ibSource]);
+            numElements += numCells;
+            other.numElements -= numCells;
+            other.iaFront = (other.iaFront + cells) % static_cast<int>(other.numCells * other.numBlocks);
+         }
+      }
+   }
+
+   // whatever is left is relocated a run at a time when it can be
+   if (canRelocate() && count > 0)
+   {
+      reserveSpan(iaFront % numCells + numElements + count);
+      while (count > 0)
+      {
+         T * pDest = slotBack();
+         int icDest = icFromID(static_cast<int>(numElements));
+         int icSource = other.icFromID(0);
+         int num = static_cast<int>(std::min(count, std::min(numCells - icDest,
+                                                             other.numCells - icSource)));
+         std::memcpy(static_cast<void *>(pDest),
+                     static_cast<const void *>(&other.data[other.ibFromID(0)][icSource]),
+                     num * sizeof(T));
+         numElements += num;
+         other.dropFront(num);
+         count -= num;
+      }
+   }
+
+   // or one element at a time
+   for (; count > 0; --count)
+   {
+      push_back(std::move(other.front()));
+      other.pop_front();
+   }
+}
+
+/*****************************************
+ * DEQUE :: SPLICE FRONT
+ * Move the last count elements of other onto our
+ * front, taking whole blocks by pointer when they line up
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::splice_front(deque & other, size_t count)
+{
+   assert(&other != this && count <= other.numElements);
+   if (count == 0)
+      return;
+
+   if (canAdoptBlocks(other))
+   {
+      // other's back must land in the cell it occupies now
+      int cells = static_cast<int>(numCells);
+      int icFrontNew = (other.icFromID(static_cast<int>(other.numElements) - 1) + 1) % cells;
+      size_t numCellsSpan = (icFrontNew + cells - count % numCells) % cells + numElements + count;
+      if (numElements == 0)
+         iaFront = icFrontNew;
+      else if (iaFront % cells != icFrontNew && numElements <= count)
+         realign(icFrontNew, numCellsSpan);
+
+      if (iaFront % cells == icFrontNew)
+      {
+         reserveSpan(numCellsSpan);
+
+         // fill our front block from other's partial back block
+         for (; count > 0 && other.icFromID(static_cast<int>(other.numElements) - 1) != cells - 1; --count)
+         {
+            push_front(std::move(other.back()));
+            other.pop_back();
+         }
+
+         // then take whole blocks
+         for (; count >= numCells; count -= numCells)
+         {
+            int ibSource = other.ibFromID(static_cast<int>(other.numElements) - 1);
+            int ibDest = iaBeforeFront() / cells;
+            std::swap(data[ibDest], other.data[ibSource]);
+            int numCellsTotal = static_cast<int>(numCells * numBlocks);
+            iaFront = (iaFront - cells + numCellsTotal) % numCellsTotal;
+            numElements += numCells;
+            other.numElements -= numCells;
+         }
+      }
+   }
+
+   // whatever is left goes one element at a time
+   for (; count > 0; --count)
+   {
+      push_front(std::move(other.back()));
+      other.pop_back();
+   }
+}
+
+/*****************************************
+ * DEQUE :: APPEND DEQUE
+ * Move all of other onto our back, leaving it empty.
+ * Its blocks are adopted by pointer; an empty deque
+ * simply takes over other's map
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::append_deque(deque && other)
+{
+   if (numElements == 0 && canAdoptBlocks(other))
+      swapState(other);
+   else
+      splice_back(other, other.numElements);
+}
+
+/*****************************************
+ * DEQUE :: SPLIT AT
+ * Return a deque holding everything from index on.
+ * It keeps each element in the same cell, so blocks
+ * holding only tail elements change owners by pointer;
+ * only the tail's share of a block we keep is moved
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR deque <T, A, P> deque <T, A, P> ::split_at(size_t index)
+{
+   assert(index <= numElements);
+   deque dTail(alloc);
+   dTail.numCells = numCells;
+   if (index == 0)
+   {
+      dTail.swapState(*this);
+      return dTail;
+   }
+   if (index == numElements)
+      return dTail;
+
+   int cells = static_cast<int>(numCells);
+   int num = static_cast<int>(numElements);
+   int idSplit = static_cast<int>(index);
+   dTail.iaFront = icFromID(idSplit);
+   dTail.reserveSpan(dTail.iaFront + numElements - index);
+
+   // the blocks holding our first and last kept elements stay with us
+   int ibKeepFront = ibFromID(0);
+   int ibKeepBack = ibFromID(idSplit - 1);
+   for (int id = idSplit; id < num; )
+   {
+      int ib = ibFromID(id);
+      int ic = icFromID(id);
+      int numRun = std::min(num - id, cells - ic);
+      int ibTail = dTail.ibFromID(id - idSplit);
+      if (ib == ibKeepFront || ib == ibKeepBack)
+      {
+         dTail.data[ibTail] = dTail.allocateBlock();
+         for (int i = ic; i < ic + numRun; i++)
+         {
+            AllocTraits::construct(alloc, &dTail.data[ibTail][i], std::move(data[ib][i]));
+            AllocTraits::destroy(alloc, &data[ib][i]);
+         }
+      }
+      else
+      {
+         dTail.data[ibTail] = data[ib];
+         data[ib] = nullptr;
+      }
+      id += numRun;
+   }
+
+   dTail.numElements = numElements - index;
+   numElements = index;
+   return dTail;
+}
+
+/*****************************************
+ * DEQUE :: REALIGN
+ * Move every element into a fresh map whose front is
+ * in cell icFrontNew, with room for numCellsSpan cells
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::realign(int icFrontNew, size_t numCellsSpan)
+{
+   deque dNew(alloc);
+   dNew.numCells = numCells;
+   dNew.iaFront = icFrontNew;
+   dNew.reserveSpan(numCellsSpan);
+   while (numElements > 0)
+   {
+      dNew.push_back(std::move(front()));
+      pop_front();
+   }
+   swapState(dNew);
+}
+
+/*****************************************
+ * DEQUE :: SWAP STATE
+ * Exchange everything with rhs
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::swapState(deque & rhs)
+{
+   std::swap(alloc, rhs.alloc);
+   std::swap(numCells, rhs.numCells);
+   std::swap(numBlocks, rhs.numBlocks);
+   std::swap(numElements, rhs.numElements);
+   std::swap(iaFront, rhs.iaFront);
+   std::swap(data, rhs.data);
+   std::swap(stats, rhs.stats);
+}
+
+/*****************************************
+ * DEQUE :: ERASE
+ * Remove one element, shifting whichever half
+ * of the deque is shorter to close the gap.
+ * Trivially relocatable elements shift by memmove
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR typename deque <T, A, P> ::iterator deque <T, A, P> ::erase(iterator it)
+{
+   int id = it.id;
+   int num = static_cast<int>(numElements);
+   assert(0 <= id && id < num);
+
+   if (canRelocate())
+   {
+      AllocTraits::destroy(alloc, &(*this)[id]);
+      if (id < num / 2)
+      {
+         relocate(1, 0, id);
+         dropFront();
+      }
+      else
+      {
+         relocate(id, id + 1, num - id - 1);
+         dropBack();
+      }
+   }
+   else if (id < num / 2)
+   {
+      // shift [0, id) toward the back over the hole
+      for (int i = id; i > 0; --i)
+         (*this)[i] = std::move((*this)[i - 1]);
+      pop_front();
+   }
+   else
+   {
+      // shift (id, num) toward the front over the hole
+      for (int i = id; i < num - 1; ++i)
+         (*this)[i] = std::move((*this)[i + 1]);
+      pop_back();
+   }
+
+   // Return an iterator to the next element
+   return iterator(id, this);
+}
+
+/*****************************************
+ * DEQUE :: RELOCATE
+ * Move num elements from idSource to idDest by copying
+ * their bytes, one block segment at a time. The ranges
+ * may overlap; the vacated slots are left raw
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::relocate(int idDest, int idSource, int num)
+{
+   int cells = static_cast<int>(numCells);
+   if (idDest < idSource)
+   {
+      // front to back so nothing is overwritten before it is read
+      while (num > 0)
+      {
+         int icDest = icFromID(idDest);
+         int icSource = icFromID(idSource);
+         int numSegment = std::min(num, cells - std::max(icDest, icSource));
+         std::memmove(static_cast<void *>(&data[ibFromID(idDest)][icDest]),
+                      static_cast<const void *>(&data[ibFromID(idSource)][icSource]),
+                      numSegment * sizeof(T));
+         idDest += numSegment;
+         idSource += numSegment;
+         num -= numSegment;
+      }
+   }
+   else
+   {
+      // back to front, each segment ending at the last remaining cell
+      while (num > 0)
+      {
+         int icDestEnd = icFromID(idDest + num - 1) + 1;
+         int icSourceEnd = icFromID(idSource + num - 1) + 1;
+         int numSegment = std::min(num, std::min(icDestEnd, icSourceEnd));
+         std::memmove(static_cast<void *>(&data[ibFromID(idDest + num - 1)][icDestEnd - numSegment]),
+                      static_cast<const void *>(&data[ibFromID(idSource + num - 1)][icSourceEnd - numSegment]),
+                      numSegment * sizeof(T));
+         num -= numSegment;
+      }
+   }
+}
+
+
+/*****************************************
+ * DEQUE :: ALLOCATE MAP
+ * An array of numBlocksMap null block pointers
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR T ** deque <T, A, P> ::allocateMap(size_t numBlocksMap, map_flat)
+{
+#if DEQUE_MREMAP_THRESHOLD > 0
+   // a fresh anonymous mapping is already zero, which is null
+   if (isMapped(numBlocksMap))
+   {
+      void * p = mmap(nullptr, numBlocksMap * sizeof(T *), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (p == MAP_FAILED)
+         throw std::bad_alloc();
+      return static_cast<T **>(p);
+   }
+#endif
+   T ** map = new T *[numBlocksMap];
+   for (size_t ib = 0; ib < numBlocksMap; ++ib)
+      map[ib] = nullptr;
+   return map;
+}
+
+/*****************************************
+ * DEQUE :: FREE MAP
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> ::freeMap(T ** map, size_t numBlocksMap)
+{
+#if DEQUE_MREMAP_THRESHOLD > 0
+   if (map != nullptr && isMapped(numBlocksMap))
+   {
+      munmap(static_cast<void *>(map), numBlocksMap * sizeof(T *));
+      return;
+   }
+#endif
+   delete [] map;
+}
+
+/*****************************************
+ * DEQUE :: GROW MAP IN PLACE
+ * Grow a mapped map with mremap. The kernel keeps
+ * the pointers, so only a wrapped deque moves any:
+ * whichever of its two runs of blocks is shorter goes
+ * into the new space. False when the copying path in
+ * reallocate must do it instead
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR bool deque <T, A, P> ::growMapInPlace(int numBlocksNew, map_flat)
+{
+#if DEQUE_MREMAP_THRESHOLD > 0
+   int nb = static_cast<int>(numBlocks);
+   if (numBlocksNew <= nb || !isMapped(numBlocks))
+      return false;
+
+   int ibFront = 0;
+   int ibBack = nb - 1;
+   if (numElements > 0)
+   {
+      int idBack = static_cast<int>(numElements) - 1;
+      ibFront = ibFromID(0);
+      ibBack = ibFromID(idBack);
+      // both ends in one block needs that block split: leave it to reallocate
+      if (ibFront == ibBack && icFromID(idBack) < icFromID(0))
+         return false;
+   }
+
+   void * p = mremap(static_cast<void *>(data), numBlocks * sizeof(T *),
+                     static_cast<size_t>(numBlocksNew) * sizeof(T *), MREMAP_MAYMOVE);
+   if (p == MAP_FAILED)
+      return false;
+   data = static_cast<T **>(p);
+
+   // the front's run ends at the old end of the map and the back's run
+   // starts at 0. Move the back's run after the old end, or the front's
+   // run to the new end, whichever is fewer pointers
+   int numGrow = numBlocksNew - nb;
+   if (numElements > 0 && ibBack < ibFront)
+   {
+      int numHead = ibBack + 1;
+      int numTail = nb - ibFront;
+      if (numHead <= numTail && numHead <= numGrow)
+      {
+         std::memcpy(data + nb, data, numHead * sizeof(T *));
+         for (int ib = 0; ib < numHead; ++ib)
+            data[ib] = nullptr;
+      }
+      else
+      {
+         int ibFrontNew = numBlocksNew - numTail;
+         std::memmove(data + ibFrontNew, data + ibFront, numTail * sizeof(T *));
+         for (int ib = ibFront; ib < std::min(nb, ibFrontNew); ++ib)
+            data[ib] = nullptr;
+         iaFront += numGrow * static_cast<int>(numCells);
+      }
+   }
+
+   numBlocks = static_cast<size_t>(numBlocksNew);
+   return true;
+#else
+   return false;
+#endif
+}
+
+/*****************************************
+ * DEQUE :: ALLOCATE BLOCK - over-aligned
+ * Whole aligned units from the allocator rebound,
+ * enough to hold numCells
+ ****************************************/
+template <typename T, typename A, typename P>
+T * deque <T, A, P> ::allocateBlock(std::true_type)
+{
+   typedef aligned_unit<P::block_alignment()> Unit;
+   typename AllocTraits::template rebind_alloc<Unit> allocUnit(alloc);
+   size_t numUnits = (numCells * sizeof(T) + sizeof(Unit) - 1) / sizeof(Unit);
+   Unit * p = std::allocator_traits<decltype(allocUnit)>::allocate(allocUnit, numUnits);
+   return reinterpret_cast<T *>(p);
+}
+
+/*****************************************
+ * DEQUE :: FREE BLOCK - over-aligned
+ ****************************************/
+template <typename T, typename A, typename P>
+void deque <T, A, P> ::freeBlock(T * pBlock, std::true_type)
+{
+   typedef aligned_unit<P::block_alignment()> Unit;
+   typename AllocTraits::template rebind_alloc<Unit> allocUnit(alloc);
+   size_t numUnits = (numCells * sizeof(T) + sizeof(Unit) - 1) / sizeof(Unit);
+   std::allocator_traits<decltype(allocUnit)>::deallocate(allocUnit, reinterpret_cast<Unit *>(pBlock), numUnits);
+}
+
+/*****************************************
+ * DEQUE :: ALLOCATE MAP - chunked
+ * A directory of chunks of null block pointers
+ ****************************************/
+template <typename T, typename A, typename P>
+template <size_t F>
+DEQUE_CONSTEXPR chunked_map<T, F> deque <T, A, P> ::allocateMap(size_t numBlocksMap, map_chunked<F>)
+{
+   size_t numChunks = numBlocksMap / F;
+   chunked_map<T, F> map;
+   map.chunks = new T **[numChunks];
+   for (size_t c = 0; c < numChunks; ++c)
+      map.chunks[c] = newChunk<F>();
+   return map;
+}
+
+/*****************************************
+ * DEQUE :: FREE MAP - chunked
+ ****************************************/
+template <typename T, typename A, typename P>
+template <size_t F>
+DEQUE_CONSTEXPR void deque <T, A, P> ::freeMap(chunked_map<T, F> map, size_t numBlocksMap)
+{
+   if (map == nullptr)
+      return;
+   for (size_t c = 0; c < numBlocksMap / F; ++c)
+      delete [] map.chunks[c];
+   delete [] map.chunks;
+}
+
+/*****************************************
+ * DEQUE :: GROW MAP IN PLACE - chunked
+ * Rebuild only the directory, rotated so the front's
+ * chunk comes first, with new empty chunks after. If
+ * the back has wrapped into the front's chunk, its
+ * blocks there move to the first new chunk. Block
+ * pointers move at most one chunk's worth
+ ****************************************/
+template <typename T, typename A, typename P>
+template <size_t F>
+DEQUE_CONSTEXPR bool deque <T, A, P> ::growMapInPlace(int numBlocksNew, map_chunked<F>)
+{
+   int nb = static_cast<int>(numBlocks);
+   if (nb == 0 || numBlocksNew <= nb)
+      return false;
+
+   int fanout = static_cast<int>(F);
+   int numChunks = nb / fanout;
+   int numChunksNew = numBlocksNew / fanout;
+   int cFront = 0;
+   int ibBackShared = -1;
+   if (numElements > 0)
+   {
+      int idBack = static_cast<int>(numElements) - 1;
+      int ibFront = ibFromID(0);
+      int ibBack = ibFromID(idBack);
+      // both ends in one block needs that block split: leave it to reallocate
+      if (ibFront == ibBack && icFromID(idBack) < icFromID(0))
+         return false;
+      cFront = ibFront / fanout;
+      if (ibBack < ibFront && ibBack / fanout == cFront)
+         ibBackShared = ibBack;
+   }
+
+   T *** chunksNew = new T **[static_cast<size_t>(numChunksNew)];
+   for (int c = 0; c < numChunks; ++c)
+      chunksNew[c] = data.chunks[(cFront + c) % numChunks];
+   for (int c = numChunks; c < numChunksNew; ++c)
+      chunksNew[c] = newChunk<F>();
+
+   // after the rotation the back's blocks in the front's chunk belong
+   // at the far end, which is the same offsets in the first new chunk
+   for (int i = 0; i <= ibBackShared % fanout; ++i)
+   {
+      chunksNew[numChunks][i] = chunksNew[0][i];
+      chunksNew[0][i] = nullptr;
+   }
+
+   delete [] data.chunks;
+   data.chunks = chunksNew;
+   iaFront -= cFront * fanout * static_cast<int>(numCells);
+   numBlocks = static_cast<size_t>(numBlocksNew);
+   return true;
+}
+
+/*****************************************
+ * DEQUE :: REALLOCATE
+ * Grow the array of blocks, unwrapping so the
+ * front block lands at index 0. Only block pointers
+ * move unless the back has wrapped into the front's block.
+ * Spare blocks keep their side: half stay after the
+ * back and half before the front. A mapped map grows
+ * in place instead, without unwrapping
+ ****************************************/
+template <typename T, typename A, typename P>
+DEQUE_CONSTEXPR void deque <T, A, P> :: reallocate(int numBlocksNew)
+{
+   assert(numBlocksNew > 0 &&
+          static_cast<size_t>(numBlocksNew) * numCells > numElements);
+
+   if (numBlocks > 0)
+      stats.mapGrown();
+   numBlocksNew = static_cast<int>(mapSize(static_cast<size_t>(numBlocksNew), map_kind()));
+   if (growMapInPlace(numBlocksNew, map_kind()))
+      return;
+
+   // Allocate a new array of pointers
+   map_type dataNew = allocateMap(static_cast<size_t>(numBlocksNew), map_kind());
+
+   // Copy over the pointers, unwrapping as we go
+   int numBlocksUsed = 0;
+   int ibSpare = numBlocks > 0 ? ibFromID(0) : 0;
+   if (numElements > 0)
+   {
+      int idBack = static_cast<int>(numElements) - 1;
+      int ibFront = ibFromID(0);
+      int ibBack = ibFromID(idBack);
+      bool wrappedInBlock = (ibFront == ibBack && icFromID(idBack) < icFromID(0));
+      numBlocksUsed = wrappedInBlock ? static_cast<int>(numBlocks) + 1 :
+         (ibBack - ibFront + static_cast<int>(numBlocks)) % static_cast<int>(numBlocks) + 1;
+      assert(numBlocksUsed <= numBlocksNew);
+
+      for (int ibNew = 0; ibNew < numBlocksUsed; ++ibNew)
+         dataNew[ibNew] = data[(ibFront + ibNew) % numBlocks];
+      ibSpare = ibBack + 1;
+
+      // If back element is in front element's block, move it
+      if (wrappedInBlock)
+      {
+         T* pBlockBack = allocateBlock();
+         if (canRelocate())
+            std::memcpy(static_cast<void *>(pBlockBack),
+                        static_cast<const void *>(data[ibBack]),
+                        (icFromID(idBack) + 1) * sizeof(T));
+         else
+            for (int ic = 0; ic <= icFromID(idBack); ic++)
+            {
+               AllocTraits::construct(alloc, &pBlockBack[ic], std::move(data[ibBack][ic]));
+               AllocTraits::destroy(alloc, &data[ibBack][ic]);
+            }
+         dataNew[numBlocksUsed - 1] = pBlockBack;
+      }
+   }
+
+   // Carry over the blocks between the back and the front
+   int numSpare = std::max(0, static_cast<int>(numBlocks) - numBlocksUsed);
+   for (int i = 0; i < numSpare; ++i)
+   {
+      T * pBlock = data[(ibSpare + i) % numBlocks];
+      if (i < numSpare / 2)
+         dataNew[numBlocksUsed + i] = pBlock;
+      else
+         dataNew[numBlocksNew - numSpare + i] = pBlock;
+   }
+
+   // Change the deque's member variables
+   freeMap(data, numBlocks);
+   data = dataNew;
+   numBlocks = numBlocksNew;
+   iaFront = iaFront % numCells;
+}
+
+/*****************************************
+ * ERASE IF
+ * Remove every element of d for which pred is
+ * true. Returns the number removed
+ ****************************************/
+template <typename T, typename A, typename P, class Pred>
+DEQUE_CONSTEXPR size_t erase_if(deque <T, A, P> & d, Pred pred)
+{
+   return d.remove_if(pred);
+}
 
 } // namespace custom
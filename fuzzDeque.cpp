@@ -0,0 +1,495 @@
+/***********************************************************************
+ * Program:
+ *    FUZZ DEQUE
+ * Summary:
+ *    Differential fuzzer for deque.h. Each input is decoded into a
+ *    sequence of operations that are applied to both custom::deque<Spy>
+ *    and std::deque<int>. After every step the contents are compared
+ *    and the Spy counters must show exactly one live, allocated Spy per
+ *    element. The same input is replayed on custom::deque<int> to cover
+ *    the memmove path taken by trivially relocatable types, and once more
+ *    on a chunked map with a tiny fanout so its directory grows often,
+ *    and under the low_latency and low_memory policies.
+ *    Any mismatch aborts so the fuzzer records the input.
+ *
+ *    libFuzzer:
+ *       clang++ -std=c++17 -g -O1 -fsanitize=fuzzer,address -DLIBFUZZER fuzzDeque.cpp
+ *    Standalone random driver:
+ *       g++ -std=c++17 -g -O1 fuzzDeque.cpp -o fuzzDeque
+ *       ./fuzzDeque [iterations] [seed]
+ * Author
+ *    Marco Varela & Andre Regino
+ ************************************************************************/
+
+#include "deque.h"     // class under test
+#include "reclaimer.h" // for custom::deque_reclaimer
+#include "spy.h"       // for Spy
+
+#include <algorithm>   // for std::min, std::remove_if, std::unique
+#include <cstdint>     // for uint8_t
+#include <cstdio>      // for fprintf
+#include <cstdlib>     // for abort, atoi
+#include <deque>       // for std::deque, the reference model
+#include <random>      // for std::mt19937
+#include <type_traits> // for std::is_same
+#include <vector>      // for std::vector
+int Spy::counters[] = {};
+
+namespace
+{
+
+/*************************************************************
+ * INPUT
+ * Hand out bytes from the fuzzer input, zeros once exhausted
+ *************************************************************/
+class Input
+{
+public:
+   Input(const uint8_t * data, size_t size) : data(data), size(size), pos(0) {}
+   bool more() const { return pos < size; }
+   uint8_t next()    { return pos < size ? data[pos++] : 0; }
+
+   // a position in [0, num]
+   int position(size_t num)
+   {
+      // two statements: the order of calls within one is unspecified
+      int hi = next();
+      int lo = next();
+      int value = (hi << 8) | lo;
+      return static_cast<int>(value % (num + 1));
+   }
+private:
+   const uint8_t * data;
+   size_t size;
+   size_t pos;
+};
+
+enum { PUSH_BACK, PUSH_FRONT, POP_BACK, POP_FRONT, INSERT, ERASE,
+       INDEX_READ, INDEX_WRITE, COPY, ASSIGN, CLEAR, POP_FRONT_INTO,
+       SPLICE_BACK, SPLICE_FRONT, SPLICE_ROUND_TRIP, APPEND, SPLIT,
+       REMOVE_IF, UNIQUE, ASSIGN_FILL, ASSIGN_RANGE, RETIRE, TRIM,
+       POP_BACK_INTO, NUM_OPS };
+
+const char * opNames[NUM_OPS] =
+{
+   "push_back", "push_front", "pop_back", "pop_front", "insert", "erase",
+   "index_read", "index_write", "copy", "assign", "clear", "pop_front_into",
+   "splice_back", "splice_front", "splice_round_trip", "append_deque",
+   "split_at", "remove_if", "unique", "assign_fill", "assign_range",
+   "retire", "trim", "pop_back_into"
+};
+
+/*************************************************************
+ * FAIL
+ * Report the step that diverged and abort
+ *************************************************************/
+void fail(const char * what, int step, int op)
+{
+   fprintf(stderr, "fuzzDeque: %s after step %d (%s)\n",
+           what, step, op >= 0 ? opNames[op] : "setup");
+   abort();
+}
+
+/*************************************************************
+ * NUM LIVE
+ * Spies constructed but not yet destroyed
+ *************************************************************/
+int numLive()
+{
+   return Spy::numDefault() + Spy::numNondefault() + Spy::numCopy()
+        + Spy::numCopyMove() - Spy::numDestructor();
+}
+
+/*************************************************************
+ * VALUE OF
+ * The model's int for an element of the custom deque. Spy
+ * goes through the element-by-element shifting code; int is
+ * trivially relocatable so it shifts by memmove
+ *************************************************************/
+int valueOf(const Spy & s) { return s.empty() ? -1 : s.get(); }
+int valueOf(int i)         { return i; }
+
+/*************************************************************
+ * VERIFY
+ * The custom deque must match the model element-for-element.
+ * numOther counts elements alive in some other deque
+ *************************************************************/
+template <typename T, typename P>
+void verify(custom::deque<T, std::allocator<T>, P> & d, const std::deque<int> & model,
+            int step, int op, size_t numOther = 0)
+{
+   if (d.size() != model.size() || d.empty() != model.empty())
+      fail("size mismatch", step, op);
+
+   if (!model.empty())
+   {
+      if (valueOf(d.front()) != model.front())
+         fail("front mismatch", step, op);
+      if (valueOf(d.back()) != model.back())
+         fail("back mismatch", step, op);
+   }
+
+   // walk with the iterator and with operator[]
+   int id = 0;
+   for (auto it = d.begin(); it != d.end(); ++it, ++id)
+      if (valueOf(*it) != model[id] || valueOf(d[id]) != model[id])
+         fail("element mismatch", step, op);
+   if (id != static_cast<int>(model.size()))
+      fail("iterator length mismatch", step, op);
+
+   // every element is exactly one live Spy holding one allocation
+   int numSpy = std::is_same<T, Spy>::value ? static_cast<int>(model.size() + numOther) : 0;
+   if (numLive() != numSpy)
+      fail("live Spy count mismatch", step, op);
+   if (Spy::numAlloc() - Spy::numDelete() != numSpy)
+      fail("Spy allocation count mismatch", step, op);
+}
+
+/*************************************************************
+ * FILL SOURCE
+ * A second deque and its model, pushed from both ends so its
+ * front can start in any cell of a block
+ *************************************************************/
+template <typename T, typename P>
+void fillSource(custom::deque<T, std::allocator<T>, P> & dSrc, std::deque<int> & modelSrc,
+                int value, int numFront)
+{
+   for (int i = 0; i < (value % 32) * 3; i++)
+   {
+      if (i < numFront)
+      {
+         dSrc.push_front(T(value + i));
+         modelSrc.push_front(value + i);
+      }
+      else
+      {
+         dSrc.push_back(T(value + i));
+         modelSrc.push_back(value + i);
+      }
+   }
+}
+
+/*************************************************************
+ * RUN
+ * Decode and apply one input
+ *************************************************************/
+template <typename T, typename P = custom::default_policy>
+void run(const uint8_t * data, size_t size)
+{
+   typedef custom::deque<T, std::allocator<T>, P> Deque;
+   Spy::reset();
+   {
+      // start from a capacity hint so spare blocks are in play
+      Input in(data, size);
+      size_t numHint = in.next();
+      size_t numHintFront = in.next();
+      Deque d(custom::capacity_hint(numHint, numHintFront));
+      std::deque<int> model;
+
+      for (int step = 0; in.more(); step++)
+      {
+         int op = in.next() % NUM_OPS;
+         int value = in.next();
+         switch (op)
+         {
+            case PUSH_BACK:
+               d.push_back(T(value));
+               model.push_back(value);
+               break;
+            case PUSH_FRONT:
+            {
+               T t(value);
+               d.push_front(t);
+               model.push_front(value);
+               break;
+            }
+            case POP_BACK:
+               if (model.empty())
+                  continue;
+               d.pop_back();
+               model.pop_back();
+               break;
+            case POP_FRONT:
+               if (model.empty())
+                  continue;
+               d.pop_front();
+               model.pop_front();
+               break;
+            case INSERT:
+            {
+               int id = in.position(model.size());
+               auto it = d.insert(typename Deque::iterator(id, &d), T(value));
+               model.insert(model.begin() + id, value);
+               if (it != typename Deque::iterator(id, &d))
+                  fail("insert returned the wrong position", step, op);
+               break;
+            }
+            case ERASE:
+            {
+               if (model.empty())
+                  continue;
+               int id = in.position(model.size() - 1);
+               d.erase(typename Deque::iterator(id, &d));
+               model.erase(model.begin() + id);
+               break;
+            }
+            case INDEX_READ:
+            {
+               if (model.empty())
+                  continue;
+               int id = in.position(model.size() - 1);
+               if (valueOf(d[id]) != model[id])
+                  fail("operator[] mismatch", step, op);
+               break;
+            }
+            case INDEX_WRITE:
+            {
+               if (model.empty())
+                  continue;
+               int id = in.position(model.size() - 1);
+               d[id] = T(value);
+               model[id] = value;
+               break;
+            }
+            case COPY:
+            {
+               // copy out, rotate the copy through its blocks so its layout
+               // differs from the original, then assign it back
+               Deque dCopy(d);
+               for (size_t i = 0; i < model.size(); i++)
+               {
+                  dCopy.pop_front();
+                  dCopy.push_back(T(model[i]));
+               }
+               d = dCopy;
+               break;
+            }
+            case ASSIGN:
+            {
+               // assign from a deque of a different size
+               Deque dSrc;
+               std::deque<int> modelSrc;
+               for (int i = 0; i < value % 40; i++)
+               {
+                  dSrc.push_front(T(value + i));
+                  modelSrc.push_front(value + i);
+               }
+               d = dSrc;
+               model = modelSrc;
+               break;
+            }
+            case CLEAR:
+               d.clear();
+               model.clear();
+               break;
+            case SPLICE_BACK:
+            {
+               Deque dSrc;
+               std::deque<int> modelSrc;
+               fillSource(dSrc, modelSrc, value, in.next());
+               int count = in.position(modelSrc.size());
+               d.splice_back(dSrc, count);
+               model.insert(model.end(), modelSrc.begin(), modelSrc.begin() + count);
+               modelSrc.erase(modelSrc.begin(), modelSrc.begin() + count);
+               verify(dSrc, modelSrc, step, op, model.size());
+               break;
+            }
+            case SPLICE_FRONT:
+            {
+               Deque dSrc;
+               std::deque<int> modelSrc;
+               fillSource(dSrc, modelSrc, value, in.next());
+               int count = in.position(modelSrc.size());
+               d.splice_front(dSrc, count);
+               model.insert(model.begin(), modelSrc.end() - count, modelSrc.end());
+               modelSrc.erase(modelSrc.end() - count, modelSrc.end());
+               verify(dSrc, modelSrc, step, op, model.size());
+               break;
+            }
+            case SPLICE_ROUND_TRIP:
+            {
+               // take the front off d and put it back
+               Deque dTmp;
+               int count = in.position(model.size());
+               dTmp.splice_back(d, count);
+               d.splice_front(dTmp, count);
+               if (!dTmp.empty())
+                  fail("splice left elements behind", step, op);
+               break;
+            }
+            case APPEND:
+            {
+               Deque dSrc;
+               std::deque<int> modelSrc;
+               fillSource(dSrc, modelSrc, value, in.next());
+               d.append_deque(std::move(dSrc));
+               model.insert(model.end(), modelSrc.begin(), modelSrc.end());
+               if (!dSrc.empty())
+                  fail("append_deque left elements behind", step, op);
+               break;
+            }
+            case SPLIT:
+            {
+               // split, check both halves, then glue them back together
+               int id = in.position(model.size());
+               Deque dTail = d.split_at(id);
+               std::deque<int> modelTail(model.begin() + id, model.end());
+               model.erase(model.begin() + id, model.end());
+               verify(d, model, step, op, modelTail.size());
+               verify(dTail, modelTail, step, op, model.size());
+               d.append_deque(std::move(dTail));
+               model.insert(model.end(), modelTail.begin(), modelTail.end());
+               break;
+            }
+            case REMOVE_IF:
+            {
+               int divisor = value % 5 + 2;
+               size_t num = custom::erase_if(d, [divisor](const T & t)
+                                             { return valueOf(t) % divisor == 0; });
+               size_t numModel = model.size();
+               model.erase(std::remove_if(model.begin(), model.end(),
+                                          [divisor](int v) { return v % divisor == 0; }),
+                           model.end());
+               if (num != numModel - model.size())
+                  fail("erase_if returned the wrong count", step, op);
+               break;
+            }
+            case UNIQUE:
+            {
+               // coarse buckets so runs are common
+               int shift = value % 8;
+               size_t num = d.unique([shift](const T & lhs, const T & rhs)
+                                     { return (valueOf(lhs) >> shift) == (valueOf(rhs) >> shift); });
+               size_t numModel = model.size();
+               model.erase(std::unique(model.begin(), model.end(),
+                                       [shift](int lhs, int rhs) { return (lhs >> shift) == (rhs >> shift); }),
+                           model.end());
+               if (num != numModel - model.size())
+                  fail("unique returned the wrong count", step, op);
+               break;
+            }
+            case ASSIGN_FILL:
+            {
+               int num = in.position(80);
+               d.assign(num, T(value));
+               model.assign(num, value);
+               break;
+            }
+            case ASSIGN_RANGE:
+            {
+               int num = in.position(80);
+               std::vector<T> values;
+               model.clear();
+               for (int i = 0; i < num; i++)
+               {
+                  values.push_back(T(value + i));
+                  model.push_back(value + i);
+               }
+               d.assign(values.begin(), values.end());
+               break;
+            }
+            case RETIRE:
+            {
+               // collect in a few small bites so big deques are cut
+               // from the back, then finish before verifying
+               custom::deque_reclaimer<T, std::allocator<T>, P> reclaimer;
+               reclaimer.retire(d);
+               model.clear();
+               for (int i = 0; i < 3; i++)
+                  reclaimer.collect(value % 4);
+               reclaimer.collect();
+               break;
+            }
+            case TRIM:
+               d.trim(value % 3);
+               break;
+            case POP_FRONT_INTO:
+            {
+               // drain up to value elements, sometimes more than there are
+               std::vector<T> out(value);
+               size_t num = d.pop_front_into(out.data(), out.size());
+               if (num != std::min(out.size(), model.size()))
+                  fail("pop_front_into returned the wrong count", step, op);
+               for (size_t i = 0; i < num; i++)
+               {
+                  if (valueOf(out[i]) != model.front())
+                     fail("pop_front_into element mismatch", step, op);
+                  model.pop_front();
+               }
+               break;
+            }
+            case POP_BACK_INTO:
+            {
+               // the back comes out first, a block segment at a time
+               std::vector<T> out(value);
+               size_t num = d.pop_back_into(out.data(), out.size());
+               if (num != std::min(out.size(), model.size()))
+                  fail("pop_back_into returned the wrong count", step, op);
+               for (size_t i = 0; i < num; i++)
+               {
+                  if (valueOf(out[i]) != model.back())
+                     fail("pop_back_into element mismatch", step, op);
+                  model.pop_back();
+               }
+               break;
+            }
+         }
+
+         // temporaries are gone, so the counters only see d's elements
+         verify(d, model, step, op);
+      }
+   }
+
+   // the deque's destructor must release every element
+   if (numLive() != 0 || Spy::numAlloc() != Spy::numDelete())
+      fail("leaked Spy after destruction", -1, -1);
+}
+
+} // namespace
+
+#ifdef LIBFUZZER
+
+/**********************************************************************
+ * LLVM FUZZER TEST ONE INPUT
+ * libFuzzer entry point
+ ***********************************************************************/
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t * data, size_t size)
+{
+   run<Spy>(data, size);
+   run<int>(data, size);
+   run<Spy, custom::with_map<custom::map_chunked<4>>>(data, size);
+   run<Spy, custom::low_latency>(data, size);
+   run<int, custom::low_memory>(data, size);
+   return 0;
+}
+
+#else
+
+/**********************************************************************
+ * MAIN
+ * Standalone driver: feed random inputs of random length
+ ***********************************************************************/
+int main(int argc, char ** argv)
+{
+   int numIterations = argc > 1 ? atoi(argv[1]) : 2000;
+   unsigned int seed = argc > 2 ? static_cast<unsigned int>(atoi(argv[2])) : 5489u;
+
+   std::mt19937 gen(seed);
+   std::vector<uint8_t> input;
+   for (int i = 0; i < numIterations; i++)
+   {
+      input.resize(gen() % 4096);
+      for (auto & byte : input)
+         byte = static_cast<uint8_t>(gen());
+      run<Spy>(input.data(), input.size());
+      run<int>(input.data(), input.size());
+      run<Spy, custom::with_map<custom::map_chunked<4>>>(input.data(), input.size());
+      run<Spy, custom::low_latency>(input.data(), input.size());
+      run<int, custom::low_memory>(input.data(), input.size());
+   }
+
+   printf("fuzzDeque: %d inputs, seed %u, no divergence\n", numIterations, seed);
+   return 0;
+}
+
+#endif // LIBFUZZER
@@ -0,0 +1,459 @@
+/***********************************************************************
+ * Header:
+ *    GEOMETRIC
+ * Summary:
+ *    A deque for very large sizes whose blocks double as they get
+ *    further from where the deque started, like a hashed array tree.
+ *    The back grows in blocks of 16, 32, 64 ... cells, and so does the
+ *    front, so a billion elements live in about 50 blocks instead of
+ *    the 60 million a fixed 16-cell block needs. There are never more
+ *    than 60 blocks a side, so the table of blocks is a fixed array and
+ *    never reallocates. Finding an element is a count of leading zeros,
+ *    a shift, and two loads.
+ *
+ *    The sizes follow the distance from the start, not the size, so a
+ *    queue that drifts (push at the back, pop at the front) moves into
+ *    ever bigger blocks. Emptying the deque starts it over at the
+ *    origin. Use custom::deque when the contents travel.
+ *
+ *    This will contain the class definition of:
+ *        geometric_deque           : A deque with doubling blocks
+ *        geometric_deque::iterator : An iterator through it
+ * Author
+ *    Marco Varela & Andre Regino
+ ************************************************************************/
+
+#pragma once
+
+#include <algorithm>   // for std::min, std::max, std::swap
+#include <cassert>     // for assert
+#include <memory>      // for std::allocator, std::allocator_traits
+#include <utility>     // for std::move
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#include <bit>         // for std::countl_zero
+#endif
+
+class TestGeometric;    // forward declaration for the unit tests
+
+namespace custom
+{
+
+/******************************************************
+ * FLOOR LOG2
+ * The index of the highest set bit of n, which must
+ * not be zero
+ *****************************************************/
+inline int floorLog2(size_t n)
+{
+   assert(n != 0);
+#if defined(__cpp_lib_bitops)
+   return static_cast<int>(sizeof(size_t) * 8 - 1) - std::countl_zero(n);
+#elif defined(__GNUC__)
+   return static_cast<int>(sizeof(unsigned long long) * 8 - 1) -
+          __builtin_clzll(static_cast<unsigned long long>(n));
+#else
+   int log = 0;
+   for (int shift = static_cast<int>(sizeof(size_t) * 4); shift > 0; shift /= 2)
+      if (n >> shift)
+      {
+         n >>= shift;
+         log += shift;
+      }
+   return log;
+#endif
+}
+
+/******************************************************
+ * GEOMETRIC DEQUE
+ * Positions count out from the origin: the back side
+ * holds 0, 1, 2 ... and the front side -1, -2, -3 ...
+ * Block ib of a side holds 16 << ib cells. Within a
+ * front block the cells are reversed so that every
+ * block is in deque order
+ *****************************************************/
+template <typename T, typename A = std::allocator<T>>
+class geometric_deque
+{
+   friend class ::TestGeometric; // give unit tests access to the privates
+public:
+   typedef T         value_type;
+   typedef size_t    size_type;
+   typedef T &       reference;
+   typedef const T & const_reference;
+
+   //
+   // Construct
+   //
+   geometric_deque(const A & a = A()) : alloc(a), numElements(0), posFront(0)
+   {
+      for (int side = 0; side < 2; side++)
+         for (int ib = 0; ib < NUM_BLOCKS_MAX; ib++)
+            blocks[side][ib] = nullptr;
+   }
+   geometric_deque(const geometric_deque & rhs);
+   geometric_deque(geometric_deque && rhs) noexcept : geometric_deque(rhs.alloc)
+   {
+      swap(rhs);
+   }
+   ~geometric_deque()
+   {
+      clear();
+      for (int side = 0; side < 2; side++)
+         for (int ib = 0; ib < NUM_BLOCKS_MAX; ib++)
+            freeBlock(side, ib);
+   }
+
+   //
+   // Assign
+   //
+   geometric_deque & operator = (const geometric_deque & rhs)
+   {
+      geometric_deque copy(rhs);
+      swap(copy);
+      return *this;
+   }
+   geometric_deque & operator = (geometric_deque && rhs) noexcept
+   {
+      swap(rhs);
+      return *this;
+   }
+   void swap(geometric_deque & rhs) noexcept;
+
+   //
+   // Iterator
+   //
+   class iterator;
+   iterator begin() { return iterator(0, this); }
+   iterator end()   { return iterator(numElements, this); }
+
+   //
+   // Access
+   //
+   T &       front()                      { return cellAt(posFront); }
+   const T & front() const                { return cellAt(posFront); }
+   T &       back()                       { return cellAt(posBack()); }
+   const T & back() const                 { return cellAt(posBack()); }
+   T &       operator [] (size_t id)       { return cellAt(posFront + static_cast<long long>(id)); }
+   const T & operator [] (size_t id) const { return cellAt(posFront + static_cast<long long>(id)); }
+
+   //
+   // Insert
+   //
+   void push_back(const T & t)  { emplaceAt(posFront + static_cast<long long>(numElements), t); }
+   void push_back(T && t)       { emplaceAt(posFront + static_cast<long long>(numElements), std::move(t)); }
+   void push_front(const T & t) { emplaceAt(posFront - 1, t); --posFront; }
+   void push_front(T && t)      { emplaceAt(posFront - 1, std::move(t)); --posFront; }
+
+   //
+   // Remove
+   //
+   void pop_back();
+   void pop_front();
+   void clear();
+
+   //
+   // Status
+   //
+   size_t size()  const { return numElements; }
+   bool   empty() const { return numElements == 0; }
+
+   //
+   // Segments
+   //
+   template <class F>
+   void for_each_segment(F f) { forEachRun(f); }
+   template <class F>
+   void for_each_segment(F f) const
+   {
+      forEachRun([&f](T * p, size_t num) { f(static_cast<const T *>(p), num); });
+   }
+
+private:
+   typedef std::allocator_traits<A> AllocTraits;
+
+   static const int CELLS_LOG_FIRST = 4;                    // the first block holds 16
+   static const int NUM_BLOCKS_MAX = 64 - CELLS_LOG_FIRST;  // enough for any size_t
+
+   // the block of side position p: p / 16 + 1 has one more bit per block
+   static int blockOf(size_t p)
+   {
+      return floorLog2((p >> CELLS_LOG_FIRST) + 1);
+   }
+   // the side position of block ib's first cell, and its size
+   static size_t blockStart(int ib)
+   {
+      return (static_cast<size_t>(1) << (ib + CELLS_LOG_FIRST)) -
+             (static_cast<size_t>(1) << CELLS_LOG_FIRST);
+   }
+   static size_t blockSize(int ib)
+   {
+      return static_cast<size_t>(1) << (ib + CELLS_LOG_FIRST);
+   }
+
+   // which side a position is on, and how far out along it
+   static int sideOf(long long pos)            { return pos < 0 ? 1 : 0; }
+   static size_t sidePosition(long long pos)
+   {
+      return pos < 0 ? static_cast<size_t>(-1 - pos) : static_cast<size_t>(pos);
+   }
+
+   // the cell within its block, front blocks reversed
+   static size_t cellOf(long long pos, int ib)
+   {
+      size_t p = sidePosition(pos);
+      return pos < 0 ? blockStart(ib) + blockSize(ib) - 1 - p : p - blockStart(ib);
+   }
+
+   T & cellAt(long long pos) const
+   {
+      int ib = blockOf(sidePosition(pos));
+      return blocks[sideOf(pos)][ib][cellOf(pos, ib)];
+   }
+
+   long long posBack() const { return posFront + static_cast<long long>(numElements) - 1; }
+
+   // the cells from pos to the end of its block, in deque order
+   static size_t runFrom(long long pos)
+   {
+      int ib = blockOf(sidePosition(pos));
+      return blockSize(ib) - cellOf(pos, ib);
+   }
+
+   // f(p, num) on each contiguous run, front to back
+   template <class F>
+   void forEachRun(F f) const;
+
+   // is the cell at pos the first or last of its block?
+   static bool isBlockEdge(long long pos)
+   {
+      size_t p = sidePosition(pos) + (static_cast<size_t>(1) << CELLS_LOG_FIRST);
+      return (p & (p - 1)) == 0 || ((p + 1) & p) == 0;
+   }
+
+   template <class U>
+   void emplaceAt(long long pos, U && u);
+   void freeBlock(int side, int ib)
+   {
+      if (blocks[side][ib] != nullptr)
+      {
+         AllocTraits::deallocate(alloc, blocks[side][ib], blockSize(ib));
+         blocks[side][ib] = nullptr;
+      }
+   }
+   void releaseIdle();
+
+   A alloc;                                // use alloc for memory allocation
+   size_t numElements;                     // number of elements in the deque
+   long long posFront;                     // position of the front element
+   T * blocks[2][NUM_BLOCKS_MAX];          // back side, then front side
+};
+
+/**************************************************
+ * GEOMETRIC DEQUE ITERATOR
+ * Bi-directional, by deque index
+ *************************************************/
+template <typename T, typename A>
+class geometric_deque <T, A> ::iterator
+{
+   friend class ::TestGeometric; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+   iterator() : id(0), d(nullptr) {}
+   iterator(size_t id, geometric_deque * d) : id(id), d(d) {}
+
+   //
+   // Compare
+   //
+   bool operator != (const iterator & rhs) const { return id != rhs.id; }
+   bool operator == (const iterator & rhs) const { return id == rhs.id; }
+
+   //
+   // Access
+   //
+   T & operator * () { return (*d)[id]; }
+
+   //
+   // Arithmetic
+   //
+   long long operator - (iterator it) const
+   {
+      return static_cast<long long>(id) - static_cast<long long>(it.id);
+   }
+   iterator & operator += (long long offset)
+   {
+      id += offset;
+      return *this;
+   }
+   iterator & operator ++ ()
+   {
+      ++id;
+      return *this;
+   }
+   iterator operator ++ (int postfix)
+   {
+      iterator temp(*this);
+      ++id;
+      return temp;
+   }
+   iterator & operator -- ()
+   {
+      --id;
+      return *this;
+   }
+   iterator operator -- (int postfix)
+   {
+      iterator temp(*this);
+      --id;
+      return temp;
+   }
+
+private:
+   size_t id;              // index of the element
+   geometric_deque * d;    // the deque it points into
+};
+
+/*****************************************
+ * GEOMETRIC DEQUE :: COPY CONSTRUCTOR
+ ****************************************/
+template <typename T, typename A>
+geometric_deque <T, A> ::geometric_deque(const geometric_deque & rhs) :
+   geometric_deque(AllocTraits::select_on_container_copy_construction(rhs.alloc))
+{
+   // delegating makes the destructor clean up if a copy throws
+   rhs.for_each_segment([this](const T * p, size_t num)
+   {
+      for (size_t i = 0; i < num; i++)
+         push_back(p[i]);
+   });
+}
+
+/*****************************************
+ * GEOMETRIC DEQUE :: SWAP
+ ****************************************/
+template <typename T, typename A>
+void geometric_deque <T, A> ::swap(geometric_deque & rhs) noexcept
+{
+   std::swap(alloc, rhs.alloc);
+   std::swap(numElements, rhs.numElements);
+   std::swap(posFront, rhs.posFront);
+   for (int side = 0; side < 2; side++)
+      for (int ib = 0; ib < NUM_BLOCKS_MAX; ib++)
+         std::swap(blocks[side][ib], rhs.blocks[side][ib]);
+}
+
+/*****************************************
+ * GEOMETRIC DEQUE :: EMPLACE AT
+ * Construct the element at pos, allocating its
+ * block first if need be. The caller moves the
+ * end once this returns
+ ****************************************/
+template <typename T, typename A>
+template <class U>
+void geometric_deque <T, A> ::emplaceAt(long long pos, U && u)
+{
+   int side = sideOf(pos);
+   int ib = blockOf(sidePosition(pos));
+   if (blocks[side][ib] == nullptr)
+      blocks[side][ib] = AllocTraits::allocate(alloc, blockSize(ib));
+   AllocTraits::construct(alloc, &blocks[side][ib][cellOf(pos, ib)], std::forward<U>(u));
+   ++numElements;
+}
+
+/*****************************************
+ * GEOMETRIC DEQUE :: POP BACK / POP FRONT
+ * Leaving a block may leave one to free
+ ****************************************/
+template <typename T, typename A>
+void geometric_deque <T, A> ::pop_back()
+{
+   assert(numElements > 0);
+   long long pos = posBack();
+   AllocTraits::destroy(alloc, &cellAt(pos));
+   --numElements;
+   if (numElements == 0 || isBlockEdge(pos))
+      releaseIdle();
+}
+
+template <typename T, typename A>
+void geometric_deque <T, A> ::pop_front()
+{
+   assert(numElements > 0);
+   long long pos = posFront;
+   AllocTraits::destroy(alloc, &cellAt(pos));
+   ++posFront;
+   --numElements;
+   if (numElements == 0 || isBlockEdge(pos))
+      releaseIdle();
+}
+
+/*****************************************
+ * GEOMETRIC DEQUE :: CLEAR
+ ****************************************/
+template <typename T, typename A>
+void geometric_deque <T, A> ::clear()
+{
+   for_each_segment([this](T * p, size_t num)
+   {
+      for (size_t i = 0; i < num; i++)
+         AllocTraits::destroy(alloc, &p[i]);
+   });
+   numElements = 0;
+   releaseIdle();
+}
+
+/*****************************************
+ * GEOMETRIC DEQUE :: RELEASE IDLE
+ * Free every block no element is in, except the
+ * one just past each end so pushing right after
+ * a pop does not allocate again. An empty deque
+ * starts over at the origin with its two small
+ * blocks
+ ****************************************/
+template <typename T, typename A>
+void geometric_deque <T, A> ::releaseIdle()
+{
+   if (numElements == 0)
+      posFront = 0;
+
+   for (int side = 0; side < 2; side++)
+   {
+      // the blocks of this side in use, if any
+      int ibLow = 0;
+      int ibHigh = -1;
+      long long posLow = side == 0 ? std::max(posFront, 0LL) : std::min(posBack(), -1LL);
+      long long posHigh = side == 0 ? posBack() : posFront;
+      if (numElements > 0 && sideOf(posLow) == side && sideOf(posHigh) == side)
+      {
+         ibLow = blockOf(sidePosition(posLow));
+         ibHigh = blockOf(sidePosition(posHigh));
+      }
+
+      for (int ib = 0; ib < NUM_BLOCKS_MAX; ib++)
+         if (ib < ibLow - 1 || ib > ibHigh + 1)
+            freeBlock(side, ib);
+   }
+}
+
+/*****************************************
+ * GEOMETRIC DEQUE :: FOR EACH RUN
+ * Call f(p, num) on each run of elements that
+ * sit next to each other in memory, front to back
+ ****************************************/
+template <typename T, typename A>
+template <class F>
+void geometric_deque <T, A> ::forEachRun(F f) const
+{
+   long long pos = posFront;
+   size_t numLeft = numElements;
+   while (numLeft > 0)
+   {
+      size_t num = std::min(runFrom(pos), numLeft);
+      f(&cellAt(pos), num);
+      pos += static_cast<long long>(num);
+      numLeft -= num;
+   }
+}
+
+} // namespace custom
@@ -0,0 +1,379 @@
+/***********************************************************************
+ * Header:
+ *    PARALLEL
+ * Summary:
+ *    Block-level work on huge deques spread over several threads.
+ *    parallel_copy() allocates the copy's map and blocks once, on the
+ *    calling thread, then copy-constructs runs of blocks concurrently.
+ *    If any element's copy throws, every element already built is
+ *    destroyed, everything is freed, and the first exception is
+ *    rethrown, just as a serial copy would leave nothing behind.
+ *    parallel_clear() destroys the elements in runs on the pool's
+ *    threads, then frees the blocks.
+ *
+ *    The allocator is only called from the calling thread. The
+ *    element's copy constructor and destructor run on the pool's
+ *    threads, so they must be safe to run for different elements at once.
+ *
+ *    This will contain the class definition of:
+ *        deque_thread_pool     : Threads that run numbered tasks
+ *        deque_parallel        : The block-level work, a friend of deque
+ * Author
+ *    Marco Varela & Andre Regino
+ ************************************************************************/
+
+#pragma once
+
+#include "deque.h"              // for custom::deque
+#include <algorithm>            // for std::min, std::max
+#include <atomic>               // for std::atomic
+#include <condition_variable>   // for std::condition_variable
+#include <cstring>              // for std::memcpy
+#include <exception>            // for std::exception_ptr
+#include <functional>           // for std::function
+#include <mutex>                // for std::mutex
+#include <thread>               // for std::thread
+#include <vector>               // for std::vector
+
+namespace custom
+{
+
+/******************************************************
+ * DEQUE THREAD POOL
+ * Worker threads that sleep until run() hands them
+ * tasks. The calling thread works too, so a pool of
+ * one has no worker threads at all
+ *****************************************************/
+class deque_thread_pool
+{
+public:
+   //
+   // Construct
+   //
+   explicit deque_thread_pool(unsigned numThreads = 0);
+   deque_thread_pool(const deque_thread_pool &) = delete;
+   deque_thread_pool & operator = (const deque_thread_pool &) = delete;
+   ~deque_thread_pool();
+
+   //
+   // Run
+   //
+   // call task(iTask) for every iTask below numTasks, in any order and
+   // on any thread, returning when all are done. task must not throw
+   void run(size_t numTasks, std::function<void(size_t)> task);
+
+   //
+   // Status
+   //
+   unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+private:
+   void work();
+   void takeTasks();
+
+   std::vector<std::thread> workers;    // every thread but the caller's
+   std::mutex mutex;                    // guards everything below but iNext
+   std::condition_variable wake;        // a new run, or stopping
+   std::condition_variable finished;    // the last worker left the run
+   std::function<void(size_t)> task;    // what the current run does
+   size_t numTasks;                     // tasks in the current run
+   std::atomic<size_t> iNext;           // the next task to take
+   size_t numWorking;                   // workers still in the current run
+   size_t generation;                   // counts runs, so workers see new ones
+   bool stopping;                       // should the workers exit?
+};
+
+/*****************************************
+ * DEQUE THREAD POOL :: CONSTRUCTOR
+ * numThreads counts the caller. Zero means one
+ * per hardware thread
+ ****************************************/
+inline deque_thread_pool::deque_thread_pool(unsigned numThreads) :
+   numTasks(0), iNext(0), numWorking(0), generation(0), stopping(false)
+{
+   if (numThreads == 0)
+      numThreads = std::max(1u, std::thread::hardware_concurrency());
+   for (unsigned i = 1; i < numThreads; i++)
+      workers.push_back(std::thread(&deque_thread_pool::work, this));
+}
+
+/*****************************************
+ * DEQUE THREAD POOL :: DESTRUCTOR
+ ****************************************/
+inline deque_thread_pool::~deque_thread_pool()
+{
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+   }
+   wake.notify_all();
+   for (std::thread & worker : workers)
+      worker.join();
+}
+
+/*****************************************
+ * DEQUE THREAD POOL :: RUN
+ ****************************************/
+inline void deque_thread_pool::run(size_t numTasksNew, std::function<void(size_t)> taskNew)
+{
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      task = std::move(taskNew);
+      numTasks = numTasksNew;
+      iNext = 0;
+      numWorking = workers.size();
+      ++generation;
+   }
+   wake.notify_all();
+
+   takeTasks();
+
+   // every worker must be out before the next run changes the task
+   std::unique_lock<std::mutex> lock(mutex);
+   finished.wait(lock, [this] { return numWorking == 0; });
+   task = nullptr;
+}
+
+/*****************************************
+ * DEQUE THREAD POOL :: TAKE TASKS
+ * Run tasks until there are none left
+ ****************************************/
+inline void deque_thread_pool::takeTasks()
+{
+   for (size_t iTask = iNext++; iTask < numTasks; iTask = iNext++)
+      task(iTask);
+}
+
+/*****************************************
+ * DEQUE THREAD POOL :: WORK
+ * A worker: wait for a run, help with it, repeat
+ ****************************************/
+inline void deque_thread_pool::work()
+{
+   size_t generationSeen = 0;
+   for (;;)
+   {
+      {
+         std::unique_lock<std::mutex> lock(mutex);
+         wake.wait(lock, [&] { return stopping || generation != generationSeen; });
+         if (stopping)
+            return;
+         generationSeen = generation;
+      }
+
+      takeTasks();
+
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--numWorking == 0)
+         finished.notify_one();
+   }
+}
+
+/******************************************************
+ * DEQUE PARALLEL
+ * The work itself, which needs the deque's blocks
+ *****************************************************/
+template <typename T, typename A, typename P>
+class deque_parallel
+{
+public:
+   static deque<T, A, P> copy(const deque<T, A, P> & src, deque_thread_pool & pool);
+   static void clear(deque<T, A, P> & d, deque_thread_pool & pool);
+
+private:
+   typedef std::allocator_traits<A> AllocTraits;
+
+   // a few tasks per thread, so a slow one does not hold up the rest
+   static size_t numTasksFor(size_t numBlocks, const deque_thread_pool & pool)
+   {
+      return std::min(numBlocks, static_cast<size_t>(pool.size()) * 4);
+   }
+
+   // the elements with index in [idBegin, idEnd) of a deque whose blocks
+   // are all in order from index 0, as a fresh copy's are
+   static void destroy(deque<T, A, P> & d, size_t idBegin, size_t idEnd);
+};
+
+/*****************************************
+ * DEQUE PARALLEL :: COPY
+ * Lay the copy out exactly like src: same block
+ * size and the front at the same cell. Then a
+ * run of src's elements that shares a block also
+ * shares one in the copy, and each task copies
+ * whole runs
+ ****************************************/
+template <typename T, typename A, typename P>
+deque<T, A, P> deque_parallel <T, A, P> ::copy(const deque<T, A, P> & src, deque_thread_pool & pool)
+{
+   deque<T, A, P> dst(src.alloc);
+   if (src.numElements == 0)
+      return dst;
+
+   // the map and every block, allocated here; dst frees them if one throws
+   size_t numCells = src.numCells;
+   size_t icFront = static_cast<size_t>(src.icFromID(0));
+   size_t numBlocksUsed = (icFront + src.numElements + numCells - 1) / numCells;
+   dst.numCells = numCells;
+   dst.reallocate(static_cast<int>(numBlocksUsed));
+   dst.iaFront = static_cast<int>(icFront);
+   for (size_t ib = 0; ib < numBlocksUsed; ib++)
+      dst.data[static_cast<int>(ib)] = dst.allocateBlock();
+
+   // each task copies a range of the copy's blocks
+   size_t numTasks = numTasksFor(numBlocksUsed, pool);
+   std::vector<char> isDone(numTasks, 0);
+   std::atomic<bool> isFailed(false);
+   std::exception_ptr failure;
+   std::mutex mutexFailure;
+   size_t numElements = src.numElements;
+
+   pool.run(numTasks, [&](size_t iTask)
+   {
+      if (isFailed)
+         return;
+
+      size_t ibBegin = numBlocksUsed * iTask / numTasks;
+      size_t ibEnd = numBlocksUsed * (iTask + 1) / numTasks;
+      size_t idBegin = ibBegin * numCells - std::min(ibBegin * numCells, icFront);
+      size_t idEnd = std::min(numElements, ibEnd * numCells - icFront);
+      size_t id = idBegin;
+      try
+      {
+         while (id < idEnd)
+         {
+            int ic = src.icFromID(static_cast<int>(id));
+            size_t num = std::min(idEnd - id, numCells - static_cast<size_t>(ic));
+            const T * pSource = &src.data[src.ibFromID(static_cast<int>(id))][ic];
+            T * pDest = &dst.data[static_cast<int>((icFront + id) / numCells)][ic];
+            if (std::is_trivially_copyable<T>::value)
+            {
+               std::memcpy(static_cast<void *>(pDest), static_cast<const void *>(pSource),
+                           num * sizeof(T));
+               id += num;
+            }
+            else
+               for (size_t i = 0; i < num; i++, id++)
+                  AllocTraits::construct(dst.alloc, pDest + i, pSource[i]);
+         }
+         isDone[iTask] = 1;
+      }
+      catch (...)
+      {
+         destroy(dst, idBegin, id);
+         std::lock_guard<std::mutex> lock(mutexFailure);
+         if (!failure)
+            failure = std::current_exception();
+         isFailed = true;
+      }
+   });
+
+   if (failure)
+   {
+      // undo the tasks that finished; dst then frees the blocks
+      for (size_t iTask = 0; iTask < numTasks; iTask++)
+         if (isDone[iTask])
+         {
+            size_t ibBegin = numBlocksUsed * iTask / numTasks;
+            size_t ibEnd = numBlocksUsed * (iTask + 1) / numTasks;
+            destroy(dst, ibBegin * numCells - std::min(ibBegin * numCells, icFront),
+                    std::min(numElements, ibEnd * numCells - icFront));
+         }
+      std::rethrow_exception(failure);
+   }
+
+   dst.numElements = numElements;
+   return dst;
+}
+
+/*****************************************
+ * DEQUE PARALLEL :: CLEAR
+ * Each task destroys a range of elements that
+ * starts and ends on a block boundary, so threads
+ * seldom touch the same block. The blocks are
+ * freed afterwards, here
+ ****************************************/
+template <typename T, typename A, typename P>
+void deque_parallel <T, A, P> ::clear(deque<T, A, P> & d, deque_thread_pool & pool)
+{
+   if (!std::is_trivially_destructible<T>::value && d.numElements > 0)
+   {
+      size_t numCells = d.numCells;
+      size_t icFront = static_cast<size_t>(d.icFromID(0));
+      size_t numElements = d.numElements;
+      size_t numBlocksUsed = (icFront + numElements + numCells - 1) / numCells;
+      size_t numTasks = numTasksFor(numBlocksUsed, pool);
+
+      pool.run(numTasks, [&](size_t iTask)
+      {
+         size_t ibBegin = numBlocksUsed * iTask / numTasks;
+         size_t ibEnd = numBlocksUsed * (iTask + 1) / numTasks;
+         size_t id = ibBegin * numCells - std::min(ibBegin * numCells, icFront);
+         size_t idEnd = std::min(numElements, ibEnd * numCells - icFront);
+         while (id < idEnd)
+         {
+            int ic = d.icFromID(static_cast<int>(id));
+            size_t num = std::min(idEnd - id, numCells - static_cast<size_t>(ic));
+            T * p = &d.data[d.ibFromID(static_cast<int>(id))][ic];
+            for (size_t i = 0; i < num; i++)
+               AllocTraits::destroy(d.alloc, p + i);
+            id += num;
+         }
+      });
+      d.numElements = 0;
+   }
+
+   d.clear();
+}
+
+/*****************************************
+ * DEQUE PARALLEL :: DESTROY
+ ****************************************/
+template <typename T, typename A, typename P>
+void deque_parallel <T, A, P> ::destroy(deque<T, A, P> & d, size_t idBegin, size_t idEnd)
+{
+   for (size_t id = idBegin; id < idEnd; id++)
+   {
+      size_t ia = static_cast<size_t>(d.iaFront) + id;
+      AllocTraits::destroy(d.alloc, &d.data[static_cast<int>(ia / d.numCells)][ia % d.numCells]);
+   }
+}
+
+/*****************************************
+ * PARALLEL COPY
+ * A copy of src built by the pool's threads, or
+ * by a pool of numThreads made for the occasion
+ ****************************************/
+template <typename T, typename A, typename P>
+deque<T, A, P> parallel_copy(const deque<T, A, P> & src, deque_thread_pool & pool)
+{
+   return deque_parallel<T, A, P>::copy(src, pool);
+}
+
+template <typename T, typename A, typename P>
+deque<T, A, P> parallel_copy(const deque<T, A, P> & src, unsigned numThreads = 0)
+{
+   deque_thread_pool pool(numThreads);
+   return deque_parallel<T, A, P>::copy(src, pool);
+}
+
+/*****************************************
+ * PARALLEL CLEAR
+ * d.clear(), with the elements destroyed by the
+ * pool's threads, or by a pool of numThreads made
+ * for the occasion. Call it on a huge deque before
+ * it goes out of scope to destroy it in parallel
+ ****************************************/
+template <typename T, typename A, typename P>
+void parallel_clear(deque<T, A, P> & d, deque_thread_pool & pool)
+{
+   deque_parallel<T, A, P>::clear(d, pool);
+}
+
+template <typename T, typename A, typename P>
+void parallel_clear(deque<T, A, P> & d, unsigned numThreads = 0)
+{
+   deque_thread_pool pool(numThreads);
+   deque_parallel<T, A, P>::clear(d, pool);
+}
+
+} // namespace custom
@@ -0,0 +1,276 @@
+/***********************************************************************
+ * Header:
+ *    QUEUE
+ * Summary:
+ *    A queue built on our custom deque. It keeps a cursor into the
+ *    back block for pushing and one into the front block for popping,
+ *    so the common case never does the deque's index arithmetic.
+ *    The deque itself is only consulted when a cursor crosses a block.
+ *
+ *    This will contain the class definition of:
+ *        queue                 : A first-in-first-out adapter over a deque
+ * Author
+ *    Marco Varela & Andre Regino
+ ************************************************************************/
+
+#pragma once
+
+#include "deque.h"     // for custom::deque
+#include <iterator>    // for std::iterator_traits, std::distance
+
+class TestQueue;    // forward declaration for TestQueue unit test class
+
+namespace custom
+{
+
+/******************************************************
+ * QUEUE
+ *****************************************************/
+template <typename T, typename A = std::allocator<T>, typename P = default_policy>
+class queue
+{
+   friend class ::TestQueue; // give unit tests access to the privates
+public:
+
+   //
+   // Construct
+   //
+   queue(const A & a = A()) : container(a), pBack(nullptr), pBackEnd(nullptr), pFront(nullptr), pFrontEnd(nullptr) {}
+   queue(const queue & rhs) : container(rhs.container) { cache(); }
+   queue(queue && rhs) : container(std::move(rhs.container))
+   {
+      cache();
+      rhs.cache();
+   }
+
+   //
+   // Assign
+   //
+   queue & operator = (const queue & rhs)
+   {
+      container = rhs.container;
+      cache();
+      return *this;
+   }
+
+   //
+   // Access
+   //
+   T & front()
+   {
+      assert(!empty());
+      return *pFront;
+   }
+   const T & front() const
+   {
+      assert(!empty());
+      return *pFront;
+   }
+   T & back()
+   {
+      assert(!empty());
+      return *(pBack - 1);
+   }
+   const T & back() const
+   {
+      assert(!empty());
+      return *(pBack - 1);
+   }
+
+   //
+   // Insert
+   //
+   void push(const T & t);
+   void push(T && t);
+   template <class InputIt>
+   void push_range(InputIt first, InputIt last)
+   {
+      pushRange(first, last, typename std::iterator_traits<InputIt>::iterator_category());
+   }
+
+   //
+   // Remove
+   //
+   void pop();
+   size_t pop_into(T * out, size_t num)
+   {
+      num = container.pop_front_into(out, num);
+      cache();
+      return num;
+   }
+
+   //
+   // Status
+   //
+   size_t size()  const { return container.size();  }
+   bool   empty() const { return container.empty(); }
+   void   reserve(size_t num)
+   {
+      container.reserve(num);
+      cache();
+   }
+   size_t trim(size_t numSpareKeep = 0) { return container.trim(numSpareKeep); }
+
+   //
+   // Segments, front to back
+   //
+   template <class F>
+   void for_each_segment(F f) const { container.for_each_segment(f); }
+
+private:
+   // find both end blocks again after the deque has done the work
+   void cache();
+
+   // push_range one element at a time, or a block's run at a time
+   // when the length is known up front
+   template <class InputIt>
+   void pushRange(InputIt first, InputIt last, std::input_iterator_tag)
+   {
+      for (; first != last; ++first)
+         push(*first);
+   }
+   template <class ForwardIt>
+   void pushRange(ForwardIt first, ForwardIt last, std::forward_iterator_tag);
+
+   typedef std::allocator_traits<A> AllocTraits;
+
+   deque<T, A, P> container;     // owns the blocks and the elements
+   T * pBack;                 // the cell just past the back
+   T * pBackEnd;              // the last cell we may push into, plus one
+   T * pFront;                // the front element
+   T * pFrontEnd;             // just past the front's run in its block
+};
+
+/*****************************************
+ * QUEUE :: PUSH
+ * Construct in place while the back block has room
+ ****************************************/
+template <typename T, typename A, typename P>
+void queue <T, A, P> ::push(const T & t)
+{
+   if (pBack != pBackEnd)
+   {
+      AllocTraits::construct(container.alloc, pBack, t);
+      // while both ends share a block, the front's run grows too
+      if (pFrontEnd == pBack)
+         ++pFrontEnd;
+      ++pBack;
+      ++container.numElements;
+   }
+   else
+   {
+      container.push_back(t);
+      cache();
+   }
+}
+
+/*****************************************
+ * QUEUE :: PUSH - move
+ ****************************************/
+template <typename T, typename A, typename P>
+void queue <T, A, P> ::push(T && t)
+{
+   if (pBack != pBackEnd)
+   {
+      AllocTraits::construct(container.alloc, pBack, std::move(t));
+      // while both ends share a block, the front's run grows too
+      if (pFrontEnd == pBack)
+         ++pFrontEnd;
+      ++pBack;
+      ++container.numElements;
+   }
+   else
+   {
+      container.push_back(std::move(t));
+      cache();
+   }
+}
+
+/*****************************************
+ * QUEUE :: PUSH RANGE - forward iterators
+ * Construct a run filling the back block, then
+ * let the deque start the next block with one
+ * element, and repeat
+ ****************************************/
+template <typename T, typename A, typename P>
+template <class ForwardIt>
+void queue <T, A, P> ::pushRange(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+{
+   size_t numLeft = static_cast<size_t>(std::distance(first, last));
+   while (numLeft > 0)
+   {
+      if (pBack == pBackEnd)
+      {
+         container.push_back(*first);
+         cache();
+         ++first;
+         --numLeft;
+         continue;
+      }
+
+      // while both ends share a block, the front's run grows too
+      bool isFrontRun = (pFrontEnd == pBack);
+      size_t numRun = std::min(numLeft, static_cast<size_t>(pBackEnd - pBack));
+      for (T * pEnd = pBack + numRun; pBack != pEnd; ++pBack, ++first)
+      {
+         AllocTraits::construct(container.alloc, pBack, *first);
+         ++container.numElements;
+      }
+      if (isFrontRun)
+         pFrontEnd = pBack;
+      numLeft -= numRun;
+   }
+}
+
+/*****************************************
+ * QUEUE :: POP
+ * Destroy in place while another element follows
+ * in the same block, so the block stays in use
+ ****************************************/
+template <typename T, typename A, typename P>
+void queue <T, A, P> ::pop()
+{
+   assert(!empty());
+   if (pFront + 1 < pFrontEnd)
+   {
+      AllocTraits::destroy(container.alloc, pFront++);
+      ++container.iaFront;
+      --container.numElements;
+   }
+   else
+   {
+      container.pop_front();
+      cache();
+   }
+}
+
+/*****************************************
+ * QUEUE :: CACHE
+ * Point at the front and just past the back.
+ * Pushes may run to the end of the back block, or
+ * to the front if the deque has wrapped into it
+ ****************************************/
+template <typename T, typename A, typename P>
+void queue <T, A, P> ::cache()
+{
+   if (container.empty())
+   {
+      pBack = pBackEnd = pFront = pFrontEnd = nullptr;
+      return;
+   }
+
+   int ibFront = container.ibFromID(0);
+   int icFront = container.icFromID(0);
+   pFront = container.data[ibFront] + icFront;
+   pFrontEnd = pFront + std::min(container.numElements, container.numCells - icFront);
+
+   int idBack = static_cast<int>(container.numElements) - 1;
+   int ib = container.ibFromID(idBack);
+   int ic = container.icFromID(idBack);
+   pBack = container.data[ib] + ic + 1;
+   pBackEnd = container.data[ib] + container.numCells;
+   if (ib == ibFront && icFront > ic)
+      pBackEnd = container.data[ib] + icFront;
+}
+
+} // namespace custom
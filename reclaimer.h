@@ -0,0 +1,250 @@
+/***********************************************************************
+ * Header:
+ *    RECLAIMER
+ * Summary:
+ *    Takes the teardown of big deques off the hot thread. retire() only
+ *    swaps the deque's map out, so it costs the same for ten elements
+ *    or ten million. The elements are destroyed and the blocks freed
+ *    later, either a bounded amount at a time from collect() when the
+ *    caller is idle, or by a background thread after start().
+ *
+ *    The allocator must tolerate freeing on another thread than the one
+ *    that allocated when the background thread is used.
+ *
+ *    This will contain the class definition of:
+ *        deque_reclaimer       : Deferred destruction of retired deques
+ * Author
+ *    Marco Varela & Andre Regino
+ ************************************************************************/
+
+#pragma once
+
+#include "deque.h"              // for custom::deque
+#include <algorithm>            // for std::min
+#include <condition_variable>   // for std::condition_variable
+#include <mutex>                // for std::mutex
+#include <thread>               // for std::thread
+#include <vector>               // for std::vector
+
+namespace custom
+{
+
+/******************************************************
+ * DEQUE RECLAIMER
+ *****************************************************/
+template <typename T, typename A = std::allocator<T>, typename P = default_policy>
+class deque_reclaimer
+{
+public:
+   //
+   // Construct
+   //
+   deque_reclaimer() : running(false) {}
+   deque_reclaimer(const deque_reclaimer &) = delete;
+   deque_reclaimer & operator = (const deque_reclaimer &) = delete;
+   ~deque_reclaimer()
+   {
+      stop();
+      collect();
+   }
+
+   //
+   // Retire
+   //
+   void retire(deque<T, A, P> & d);
+
+   //
+   // Reclaim
+   //
+   size_t collect(size_t maxBlocks = static_cast<size_t>(-1));
+   void start();
+   void stop();
+
+   //
+   // Status
+   //
+   size_t pending() const
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      return retired.size();
+   }
+
+private:
+   // destroy up to maxBlocks blocks of d, returning the blocks freed
+   static size_t release(deque<T, A, P> & d, size_t maxBlocks);
+   static size_t numAllocated(const deque<T, A, P> & d);
+   static size_t numInUse(const deque<T, A, P> & d);
+   void work();
+
+   std::vector<deque<T, A, P>> retired;  // waiting to be destroyed
+   mutable std::mutex mutex;          // guards retired and running
+   std::condition_variable wake;      // tells the thread there is work
+   std::thread worker;                // the background thread, if started
+   bool running;                      // should the thread keep waiting?
+};
+
+/*****************************************
+ * DEQUE RECLAIMER :: RETIRE
+ * Take over d's map, blocks, and elements. d is
+ * left empty and ready for reuse. Only the hand
+ * off happens here; nothing is destroyed
+ ****************************************/
+template <typename T, typename A, typename P>
+void deque_reclaimer <T, A, P> ::retire(deque<T, A, P> & d)
+{
+   if (d.data == nullptr)
+      return;
+
+   deque<T, A, P> taken(std::move(d));
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      retired.push_back(std::move(taken));
+   }
+   wake.notify_one();
+}
+
+/*****************************************
+ * DEQUE RECLAIMER :: COLLECT
+ * Destroy retired deques until maxBlocks
+ * blocks are freed. A deque bigger than what is
+ * left of the budget is cut from the back and
+ * finished by a later call. Returns the blocks freed
+ ****************************************/
+template <typename T, typename A, typename P>
+size_t deque_reclaimer <T, A, P> ::collect(size_t maxBlocks)
+{
+   // destroy outside the lock so retire never waits on us
+   std::vector<deque<T, A, P>> batch;
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      batch.swap(retired);
+   }
+
+   size_t numFreed = 0;
+   while (!batch.empty() && numFreed < maxBlocks)
+   {
+      numFreed += release(batch.back(), maxBlocks - numFreed);
+      if (batch.back().data == nullptr)
+         batch.pop_back();
+   }
+
+   if (!batch.empty())
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (deque<T, A, P> & d : batch)
+         retired.push_back(std::move(d));
+   }
+   return numFreed;
+}
+
+/*****************************************
+ * DEQUE RECLAIMER :: RELEASE
+ * Free d's spare blocks first, as they hold no
+ * elements. Then, if d still has more blocks than
+ * the budget, cut whole blocks' worth of elements
+ * off the back; otherwise destroy d outright
+ ****************************************/
+template <typename T, typename A, typename P>
+size_t deque_reclaimer <T, A, P> ::release(deque<T, A, P> & d, size_t maxBlocks)
+{
+   size_t numSpare = numAllocated(d) - numInUse(d);
+   size_t numFreed = d.trim(numSpare > maxBlocks ? numSpare - maxBlocks : 0);
+   if (numFreed >= maxBlocks)
+      return numFreed;
+
+   size_t maxLeft = maxBlocks - numFreed;
+   if (numInUse(d) <= maxLeft)
+   {
+      numFreed += numAllocated(d);
+      deque<T, A, P> doomed(std::move(d));
+      return numFreed;
+   }
+
+   // the back's block, then maxLeft - 1 full ones before it
+   size_t numBefore = numAllocated(d);
+   size_t numCut = static_cast<size_t>(d.icFromID(static_cast<int>(d.numElements) - 1)) + 1 +
+                   (maxLeft - 1) * d.numCells;
+   d.truncate(d.numElements - numCut);
+   d.trim();
+   return numFreed + numBefore - numAllocated(d);
+}
+
+/*****************************************
+ * DEQUE RECLAIMER :: NUM ALLOCATED
+ * Blocks d holds, with elements or not
+ ****************************************/
+template <typename T, typename A, typename P>
+size_t deque_reclaimer <T, A, P> ::numAllocated(const deque<T, A, P> & d)
+{
+   size_t num = 0;
+   for (size_t ib = 0; ib < d.numBlocks; ib++)
+      if (d.data[static_cast<int>(ib)] != nullptr)
+         num++;
+   return num;
+}
+
+/*****************************************
+ * DEQUE RECLAIMER :: NUM IN USE
+ * Blocks holding at least one of d's elements
+ ****************************************/
+template <typename T, typename A, typename P>
+size_t deque_reclaimer <T, A, P> ::numInUse(const deque<T, A, P> & d)
+{
+   if (d.numElements == 0)
+      return 0;
+   size_t icFront = static_cast<size_t>(d.icFromID(0));
+   return std::min(d.numBlocks, (icFront + d.numElements + d.numCells - 1) / d.numCells);
+}
+
+/*****************************************
+ * DEQUE RECLAIMER :: START
+ * Collect on a background thread from now on
+ ****************************************/
+template <typename T, typename A, typename P>
+void deque_reclaimer <T, A, P> ::start()
+{
+   std::lock_guard<std::mutex> lock(mutex);
+   if (running)
+      return;
+   running = true;
+   worker = std::thread(&deque_reclaimer::work, this);
+}
+
+/*****************************************
+ * DEQUE RECLAIMER :: STOP
+ * Let the background thread finish what is
+ * already retired, then wait for it
+ ****************************************/
+template <typename T, typename A, typename P>
+void deque_reclaimer <T, A, P> ::stop()
+{
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      running = false;
+   }
+   wake.notify_all();
+   if (worker.joinable())
+      worker.join();
+}
+
+/*****************************************
+ * DEQUE RECLAIMER :: WORK
+ * The background thread: sleep until something
+ * is retired, collect it, repeat until stopped
+ ****************************************/
+template <typename T, typename A, typename P>
+void deque_reclaimer <T, A, P> ::work()
+{
+   for (;;)
+   {
+      {
+         std::unique_lock<std::mutex> lock(mutex);
+         wake.wait(lock, [this] { return !running || !retired.empty(); });
+         if (!running && retired.empty())
+            return;
+      }
+      collect();
+   }
+}
+
+} // namespace custom
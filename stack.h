@@ -0,0 +1,248 @@
+/***********************************************************************
+ * Header:
+ *    STACK
+ * Summary:
+ *    A stack built on our custom deque. It only ever touches the back
+ *    of the deque, so it keeps a cursor into the top block and pushes,
+ *    pops, and reads the top without the deque's index arithmetic.
+ *    The deque itself is only consulted when the top crosses a block.
+ *
+ *    This will contain the class definition of:
+ *        stack                 : A last-in-first-out adapter over a deque
+ * Author
+ *    Marco Varela & Andre Regino
+ ************************************************************************/
+
+#pragma once
+
+#include "deque.h"     // for custom::deque
+#include <iterator>    // for std::iterator_traits, std::distance
+
+class TestStack;    // forward declaration for TestStack unit test class
+
+namespace custom
+{
+
+/******************************************************
+ * STACK
+ *****************************************************/
+template <typename T, typename A = std::allocator<T>, typename P = default_policy>
+class stack
+{
+   friend class ::TestStack; // give unit tests access to the privates
+public:
+
+   //
+   // Construct
+   //
+   stack(const A & a = A()) : container(a), pNext(nullptr), pBlockBegin(nullptr), pBlockEnd(nullptr) {}
+   stack(const stack & rhs) : container(rhs.container) { cache(); }
+   stack(stack && rhs) : container(std::move(rhs.container))
+   {
+      cache();
+      rhs.cache();
+   }
+
+   //
+   // Assign
+   //
+   stack & operator = (const stack & rhs)
+   {
+      container = rhs.container;
+      cache();
+      return *this;
+   }
+
+   //
+   // Access
+   //
+   T & top()
+   {
+      assert(!empty());
+      return *(pNext - 1);
+   }
+   const T & top() const
+   {
+      assert(!empty());
+      return *(pNext - 1);
+   }
+
+   //
+   // Insert
+   //
+   void push(const T & t);
+   void push(T && t);
+   template <class InputIt>
+   void push_range(InputIt first, InputIt last)
+   {
+      pushRange(first, last, typename std::iterator_traits<InputIt>::iterator_category());
+   }
+
+   //
+   // Remove
+   //
+   void pop();
+   size_t pop_into(T * out, size_t num)
+   {
+      num = container.pop_back_into(out, num);
+      cache();
+      return num;
+   }
+
+   //
+   // Status
+   //
+   size_t size()  const { return container.size();  }
+   bool   empty() const { return container.empty(); }
+   void   reserve(size_t num)
+   {
+      container.reserve(num);
+      cache();
+   }
+   size_t trim(size_t numSpareKeep = 0) { return container.trim(numSpareKeep); }
+
+   //
+   // Segments, bottom to top
+   //
+   template <class F>
+   void for_each_segment(F f) const { container.for_each_segment(f); }
+
+private:
+   // find the top block again after the deque has done the work
+   void cache();
+
+   // push_range one element at a time, or a block's run at a time
+   // when the length is known up front
+   template <class InputIt>
+   void pushRange(InputIt first, InputIt last, std::input_iterator_tag)
+   {
+      for (; first != last; ++first)
+         push(*first);
+   }
+   template <class ForwardIt>
+   void pushRange(ForwardIt first, ForwardIt last, std::forward_iterator_tag);
+
+   typedef std::allocator_traits<A> AllocTraits;
+
+   deque<T, A, P> container;     // owns the blocks and the elements
+   T * pNext;                 // the cell just past the top
+   T * pBlockBegin;           // the first cell of the top's block
+   T * pBlockEnd;             // the last cell we may push into, plus one
+};
+
+/*****************************************
+ * STACK :: PUSH
+ * Construct in place while the top block has room
+ ****************************************/
+template <typename T, typename A, typename P>
+void stack <T, A, P> ::push(const T & t)
+{
+   if (pNext != pBlockEnd)
+   {
+      AllocTraits::construct(container.alloc, pNext++, t);
+      ++container.numElements;
+   }
+   else
+   {
+      container.push_back(t);
+      cache();
+   }
+}
+
+/*****************************************
+ * STACK :: PUSH - move
+ ****************************************/
+template <typename T, typename A, typename P>
+void stack <T, A, P> ::push(T && t)
+{
+   if (pNext != pBlockEnd)
+   {
+      AllocTraits::construct(container.alloc, pNext++, std::move(t));
+      ++container.numElements;
+   }
+   else
+   {
+      container.push_back(std::move(t));
+      cache();
+   }
+}
+
+/*****************************************
+ * STACK :: POP
+ * Destroy in place unless that would empty the
+ * top block, which the deque must then free
+ ****************************************/
+template <typename T, typename A, typename P>
+void stack <T, A, P> ::pop()
+{
+   assert(!empty());
+   if (pNext - 1 != pBlockBegin && container.numElements > 1)
+   {
+      AllocTraits::destroy(container.alloc, --pNext);
+      --container.numElements;
+   }
+   else
+   {
+      container.pop_back();
+      cache();
+   }
+}
+
+/*****************************************
+ * STACK :: PUSH RANGE - forward iterators
+ * Construct a run filling the top block, then
+ * let the deque start the next block with one
+ * element, and repeat
+ ****************************************/
+template <typename T, typename A, typename P>
+template <class ForwardIt>
+void stack <T, A, P> ::pushRange(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+{
+   size_t numLeft = static_cast<size_t>(std::distance(first, last));
+   while (numLeft > 0)
+   {
+      if (pNext == pBlockEnd)
+      {
+         container.push_back(*first);
+         cache();
+         ++first;
+         --numLeft;
+         continue;
+      }
+
+      size_t numRun = std::min(numLeft, static_cast<size_t>(pBlockEnd - pNext));
+      for (T * pEnd = pNext + numRun; pNext != pEnd; ++pNext, ++first)
+      {
+         AllocTraits::construct(container.alloc, pNext, *first);
+         ++container.numElements;
+      }
+      numLeft -= numRun;
+   }
+}
+
+/*****************************************
+ * STACK :: CACHE
+ * Point at the cell after the top. Pushes may run to
+ * the end of the block, or to the front if the deque
+ * has wrapped into the same block
+ ****************************************/
+template <typename T, typename A, typename P>
+void stack <T, A, P> ::cache()
+{
+   if (container.empty())
+   {
+      pNext = pBlockBegin = pBlockEnd = nullptr;
+      return;
+   }
+
+   int idTop = static_cast<int>(container.numElements) - 1;
+   int ib = container.ibFromID(idTop);
+   int ic = container.icFromID(idTop);
+   pBlockBegin = container.data[ib];
+   pNext = pBlockBegin + ic + 1;
+   pBlockEnd = pBlockBegin + container.numCells;
+   if (ib == container.ibFromID(0) && container.icFromID(0) > ic)
+      pBlockEnd = pBlockBegin + container.icFromID(0);
+}
+
+} // namespace custom
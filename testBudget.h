@@ -0,0 +1,258 @@
+/***********************************************************************
+ * Header:
+ *    TEST BUDGET
+ * Summary:
+ *    Unit tests for the shared deque budget
+ * Author
+ *    Marco Varela & Andre Regino
+ ************************************************************************/
+
+#pragma once
+#ifdef DEBUG
+
+#include "budget.h"     // class under test
+#include "queue.h"      // for custom::queue
+#include "spy.h"        // for the Spy class
+#include "unitTest.h"   // unit test baseclass
+#include <new>          // for std::bad_alloc
+#include <thread>       // for std::thread
+
+/***********************************************
+ * TEST BUDGET
+ * Unit tests for the shared deque budget
+ ***********************************************/
+class TestBudget : public UnitTest
+{
+public:
+   typedef custom::deque<int, custom::budget_allocator<int>> BudgetDeque;
+
+   void run()
+   {
+      reset();
+
+      // Charge
+      test_charge_perBlock();
+      test_charge_shared();
+
+      // Over the limit
+      test_limit_throws();
+      test_limit_evicts();
+      test_limit_refuses();
+      test_limit_hint();
+      test_limit_queue();
+      test_limit_setEvictRacing();
+
+      report("Budget");
+   }
+
+   /***************************************
+    * CHARGE
+    ***************************************/
+
+   // a block is charged when allocated and released when freed
+   void test_charge_perBlock()
+   {  // setup
+      custom::deque_budget budget(1 << 20);
+      BudgetDeque d(budget);
+      // exercise
+      for (int i = 0; i < 16; i++)
+         d.push_back(i);
+      // verify
+      assertUnit(budget.used() == 16 * sizeof(int));
+      // exercise
+      d.push_back(16);
+      // verify
+      assertUnit(budget.used() == 32 * sizeof(int));
+      assertUnit(budget.available() == (1 << 20) - 32 * sizeof(int));
+      // exercise
+      d.clear();
+      // verify
+      assertUnit(budget.used() == 0);
+   }  // teardown
+
+   // deques on one budget add up, and can pass blocks between them
+   void test_charge_shared()
+   {  // setup
+      custom::deque_budget budget(1 << 20);
+      BudgetDeque d1(budget);
+      BudgetDeque d2(budget);
+      for (int i = 0; i < 32; i++)
+         d1.push_back(i);
+      for (int i = 0; i < 16; i++)
+         d2.push_back(i);
+      assertUnit(budget.used() == 48 * sizeof(int));
+      // exercise
+      d1.append_deque(std::move(d2));
+      // verify
+      assertUnit(d1.size() == 48);
+      assertUnit(budget.used() == 48 * sizeof(int));
+   }  // teardown
+
+   /***************************************
+    * OVER THE LIMIT
+    ***************************************/
+
+   // with no callback, the block that does not fit throws and
+   // the deque is left as it was
+   void test_limit_throws()
+   {  // setup
+      custom::deque_budget budget(32 * sizeof(int));
+      BudgetDeque d(budget);
+      for (int i = 0; i < 32; i++)
+         d.push_back(i);
+      // exercise
+      bool thrown = false;
+      try
+      {
+         d.push_back(32);
+      }
+      catch (const std::bad_alloc &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(d.size() == 32);
+      assertUnit(d.back() == 31);
+      assertUnit(budget.used() == 32 * sizeof(int));
+      // freeing a block makes room again
+      for (int i = 0; i < 16; i++)
+         d.pop_front();
+      d.push_back(32);
+      assertUnit(d.back() == 32);
+   }  // teardown
+
+   // the callback may evict from another deque and retry
+   void test_limit_evicts()
+   {  // setup
+      custom::deque_budget budget(32 * sizeof(int));
+      BudgetDeque dOld(budget);
+      BudgetDeque dNew(budget);
+      size_t numAsked = 0;
+      budget.set_evict([&](size_t numBytes)
+      {
+         numAsked = numBytes;
+         for (int i = 0; i < 16 && !dOld.empty(); i++)
+            dOld.pop_front();
+         return true;
+      });
+      for (int i = 0; i < 32; i++)
+         dOld.push_back(i);
+      // exercise
+      dNew.push_back(99);
+      // verify
+      assertUnit(numAsked == 16 * sizeof(int));
+      assertUnit(dOld.size() == 16);
+      assertUnit(dOld.front() == 16);
+      assertUnit(dNew.size() == 1);
+      assertUnit(budget.used() == 32 * sizeof(int));
+   }  // teardown
+
+   // the callback may refuse, which pushes back on the caller
+   void test_limit_refuses()
+   {  // setup
+      custom::deque_budget budget(16 * sizeof(Spy), [](size_t) { return false; });
+      custom::deque<Spy, custom::budget_allocator<Spy>> d(budget);
+      for (int i = 0; i < 16; i++)
+         d.push_back(Spy(i));
+      Spy::reset();
+      // exercise
+      bool thrown = false;
+      try
+      {
+         d.push_front(Spy(-1));
+      }
+      catch (const std::bad_alloc &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAlloc() == 1);
+      assertUnit(Spy::numDelete() == 1);
+      assertUnit(d.size() == 16);
+      assertUnit(d.front() == Spy(0));
+   }  // teardown
+
+   // a capacity hint over the limit gives back what it got
+   void test_limit_hint()
+   {  // setup
+      custom::deque_budget budget(32 * sizeof(int));
+      // exercise
+      bool thrown = false;
+      try
+      {
+         BudgetDeque d(custom::capacity_hint(64), budget);
+      }
+      catch (const std::bad_alloc &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(budget.used() == 0);
+   }  // teardown
+
+   // the adapters take the same allocator
+   void test_limit_queue()
+   {  // setup
+      custom::deque_budget budget(32 * sizeof(int));
+      custom::queue<int, custom::budget_allocator<int>> q(budget);
+      // exercise
+      int numPushed = 0;
+      try
+      {
+         for (; numPushed < 100; numPushed++)
+            q.push(numPushed);
+      }
+      catch (const std::bad_alloc &)
+      {
+      }
+      // verify
+      assertUnit(numPushed == 32);
+      assertUnit(q.size() == 32);
+      assertUnit(q.back() == 31);
+      // exercise
+      for (int i = 0; i < 16; i++)
+         q.pop();
+      q.push(32);
+      // verify
+      assertUnit(q.size() == 17);
+      assertUnit(q.front() == 16);
+      assertUnit(q.back() == 32);
+   }  // teardown
+
+   // the callback may be swapped while another thread is over the limit
+   void test_limit_setEvictRacing()
+   {  // setup
+      custom::deque_budget budget(16 * sizeof(int));
+      int numRefused = 0;
+      std::thread worker([&]()
+      {
+         BudgetDeque d(budget);
+         for (int i = 0; i < 2000; i++)
+         {
+            try
+            {
+               for (int j = 0; j < 17; j++)
+                  d.push_back(j);
+            }
+            catch (const std::bad_alloc &)
+            {
+               numRefused++;
+            }
+            d.clear();
+         }
+      });
+      // exercise
+      for (int i = 0; i < 2000; i++)
+         budget.set_evict([](size_t) { return false; });
+      worker.join();
+      // verify
+      assertUnit(numRefused == 2000);
+      assertUnit(budget.used() == 0);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -14,6 +14,12 @@
 
 #include "testDeque.h"       // for the deque unit tests
 #include "testSpy.h"         // for the spy unit tests
+#include "testQueue.h"       // for the queue unit tests
+#include "testStack.h"       // for the stack unit tests
+#include "testReclaimer.h"   // for the reclaimer unit tests
+#include "testBudget.h"      // for the budget unit tests
+#include "testGeometric.h"   // for the geometric deque unit tests
+#include "testParallel.h"    // for the parallel copy unit tests
 int Spy::counters[] = {};
 
 /**********************************************************************
@@ -26,6 +32,12 @@ int main()
    // unit tests
    TestSpy().run();
    TestDeque().run();
+   TestQueue().run();
+   TestStack().run();
+   TestReclaimer().run();
+   TestBudget().run();
+   TestGeometric().run();
+   TestParallel().run();
 #endif // DEBUG
    
    return 0;
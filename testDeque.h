@@ -21,6 +21,55 @@
 
 #include <deque>
 
+/***********************************************
+ * COUNTING ALLOCATOR
+ * A std::allocator that counts block allocations
+ * so tests can check how often the deque allocates
+ ***********************************************/
+template <typename T>
+class CountingAllocator : public std::allocator<T>
+{
+public:
+   template <typename U>
+   struct rebind { typedef CountingAllocator<U> other; };
+
+   CountingAllocator() : numAllocate(0), numDeallocate(0) {}
+   template <typename U>
+   CountingAllocator(const CountingAllocator<U>&) : numAllocate(0), numDeallocate(0) {}
+
+   T* allocate(size_t n)
+   {
+      numAllocate++;
+      return std::allocator<T>::allocate(n);
+   }
+   void deallocate(T* p, size_t n)
+   {
+      numDeallocate++;
+      std::allocator<T>::deallocate(p, n);
+   }
+
+   int numAllocate;
+   int numDeallocate;
+};
+
+/***********************************************
+ * RELOCATABLE SPY
+ * A Spy only owns a pointer, so moving one by copying
+ * its bytes is safe. Opting it in lets the tests count
+ * the moves and destroys that relocation skips
+ ***********************************************/
+class RelocatableSpy : public Spy
+{
+public:
+   using Spy::Spy;
+};
+
+namespace custom
+{
+   template <>
+   struct is_trivially_relocatable<RelocatableSpy> : std::true_type {};
+}
+
 class TestDeque : public UnitTest
 {
 public:
@@ -36,29 +85,40 @@ public:
       test_iaFromID_4x1();
       test_iaFromID_3x3();
       test_realloc_emptyToOne();
-//      test_realloc_oneToTwo();
-      //test_realloc_shift();
-      //test_realloc_wrapBetweenBlocks();
-      //test_realloc_complex();
+      test_realloc_oneToTwo();
+      test_realloc_shift();
+      test_realloc_wrapBetweenBlocks();
+      test_realloc_complex();
+#if DEQUE_MREMAP_THRESHOLD > 0
+      test_realloc_mappedMoveFront();
+      test_realloc_mappedMoveBack();
+#endif
+      test_realloc_chunkedRotate();
+      test_realloc_chunkedSharedChunk();
 
       // Construct
       test_construct_default();
-//      test_constructCopy_empty();
-//      test_constructCopy_standard();
+      test_construct_hint();
+      test_construct_hintSpareBlocks();
+      test_constructCopy_empty();
+      test_constructCopy_standard();
       test_constructCopy_wrapped();
 
       // Assign
       test_assign_emptyToEmpty();
       test_assign_emptyToStandard();
-      //test_assign_standardToStandard();
-      //test_assign_standardToEmpty();
-      //test_assign_wrapped();
+      test_assign_standardToStandard();
+      test_assign_standardToEmpty();
+      test_assign_wrapped();
+      test_assignfill_shrink();
+      test_assignrange_grow();
 
       // Iterator
       test_iterator_begin_empty();
       test_iterator_begin_standard();
       test_iterator_end_standard();
       test_iterator_increment_standardMiddle();
+      test_iterator_increment_acrossBlocks();
       test_iterator_dereference_read();
       test_iterator_dereference_update();
       test_iterator_add_withinBlock();
@@ -76,19 +136,24 @@ public:
       test_subscript_readWrapped();
       test_subscript_writeStandard();
       test_subscript_writeWrapped();
+      test_gather_wrapped();
+      test_gather_sortedPowerOfTwo();
 
       // Insert
-      //test_pushback_empty();
-      //test_pushback_roomNoWrap();
-      //test_pushback_newBlock();
-      //test_pushback_wrap();
-      //test_pushback_complex();
-      //test_pushfront_empty();
-      //test_pushfront_roomNoWrap();
-      //test_pushfront_newBlock();
-      //test_pushfront_wrap();
-      //test_pushfront_complex();
-      //test_pushfront_bigWrap();
+      test_pushback_empty();
+      test_pushback_roomNoWrap();
+      test_pushback_newBlock();
+      test_pushback_wrap();
+      test_pushback_complex();
+      test_pushfront_empty();
+      test_pushfront_roomNoWrap();
+      test_pushfront_newBlock();
+      test_pushfront_wrap();
+      test_pushfront_complex();
+      test_pushfront_bigWrap();
+      test_insert_frontHalf();
+      test_insert_backHalf();
+      test_insert_relocate();
 
       // Remove
       test_clear_empty();
@@ -98,18 +163,63 @@ public:
       test_popfront_lastElement();
       test_popfront_lastInBlock(); 
       test_popfront_complex();
+      test_popfrontinto_standard();
+      test_popfrontinto_wrappedAll();
+      test_popfrontinto_trivial();
+      test_popbackinto_standard();
+      test_popbackinto_wrappedAll();
       test_popback_unwrap();
       test_popback_standard();
       test_popback_lastElement();
       test_popback_lastInBlock();
       test_popback_complex();
+      test_erase_frontHalf();
+      test_erase_backHalf();
+      test_erase_relocate();
+      test_removeif_shiftSurvivors();
+      test_removeif_freeBlock();
+      test_unique_runs();
+
+      // Splice
+      test_spliceback_empty();
+      test_splicefront_realign();
+      test_appenddeque_seam();
+      test_appenddeque_empty();
+      test_splitat_adoptBlocks();
+      test_splitat_wrappedShared();
 
       // Status
       test_size_empty();
       test_size_standard();
       test_empty_empty();
       test_empty_standard();
+      test_trim_spares();
+      test_trim_keepNearBack();
+      test_trim_empty();
+
+      // Policy
+      test_policy_blockCells();
+      test_policy_grow();
+      test_policy_cacheSpare();
+      test_policy_cacheSpareShrink();
+      test_policy_alignment();
+      test_policy_stats();
+      test_policy_statsMove();
+      test_policy_fitSizeClass();
+      test_allocateAtLeast_firstBlock();
+
+      // Constexpr
+      test_constexpr_build();
 
+      // Complexity
+      test_complexity_pushBack();
+      test_complexity_pushFront();
+      test_complexity_pop();
+      test_complexity_copy();
+      test_complexity_access();
+      test_complexity_insertErase();
+      test_complexity_insertEraseEnds();
+      test_complexity_clear();
 
       report("Deque");
    }
@@ -375,7 +485,7 @@ public:
       d.numBlocks = 1;
       d.data = new Spy * [1];
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][1], Spy(99));
+      construct(d.alloc, &d.data[0][1], Spy(99));
       d.iaFront = 1;
       Spy * pFirstBlock = d.data[0];
       Spy::reset();
@@ -433,9 +543,9 @@ public:
       d.data = new Spy * [2];
       d.data[0] = nullptr;
       d.data[1] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[1][0], Spy(67));
-      d.alloc.construct(&d.data[1][1], Spy(79));
-      d.alloc.construct(&d.data[1][2], Spy(85));
+      construct(d.alloc, &d.data[1][0], Spy(67));
+      construct(d.alloc, &d.data[1][1], Spy(79));
+      construct(d.alloc, &d.data[1][2], Spy(85));
       d.iaFront = 3;
       Spy* pFirstBlock = d.data[1];
       Spy::reset();
@@ -502,9 +612,9 @@ public:
       d.data[1] = nullptr;
       d.data[2] = nullptr;
       d.data[3] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[3][0], Spy(11));
-      d.alloc.construct(&d.data[3][1], Spy(28));
-      d.alloc.construct(&d.data[0][0], Spy(31));
+      construct(d.alloc, &d.data[3][0], Spy(11));
+      construct(d.alloc, &d.data[3][1], Spy(28));
+      construct(d.alloc, &d.data[0][0], Spy(31));
       d.iaFront = 6;
       Spy* pFirstBlock = d.data[3];
       Spy* pSecondBlock = d.data[0];
@@ -574,14 +684,14 @@ public:
       d.data[0] = d.alloc.allocate(d.numCells);
       d.data[1] = d.alloc.allocate(d.numCells);
       d.data[2] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[1][1], Spy(11));
-      d.alloc.construct(&d.data[1][2], Spy(28));
-      d.alloc.construct(&d.data[2][0], Spy(31));
-      d.alloc.construct(&d.data[2][1], Spy(49));
-      d.alloc.construct(&d.data[2][2], Spy(59));
-      d.alloc.construct(&d.data[0][0], Spy(67));
-      d.alloc.construct(&d.data[0][1], Spy(79));
-      d.alloc.construct(&d.data[0][2], Spy(85));
+      construct(d.alloc, &d.data[1][1], Spy(11));
+      construct(d.alloc, &d.data[1][2], Spy(28));
+      construct(d.alloc, &d.data[2][0], Spy(31));
+      construct(d.alloc, &d.data[2][1], Spy(49));
+      construct(d.alloc, &d.data[2][2], Spy(59));
+      construct(d.alloc, &d.data[0][0], Spy(67));
+      construct(d.alloc, &d.data[0][1], Spy(79));
+      construct(d.alloc, &d.data[0][2], Spy(85));
       d.iaFront = 4;
       Spy* pFirstBlock = d.data[0];
       Spy* pSecondBlock = d.data[1];
@@ -639,6 +749,128 @@ public:
       // teardown
       teardownStandardFixture(d);
    }
+#if DEQUE_MREMAP_THRESHOLD > 0
+   // a mapped map grows in place; the front's short run moves to the end
+   void test_realloc_mappedMoveFront()
+   {  // setup
+      //   [0 1 2 ... N-11 | -10 ... -1]
+      custom::deque<int> d;
+      d.numCells = 1;
+      int num = DEQUE_MREMAP_THRESHOLD / static_cast<int>(sizeof(int *));
+      d.reserve(num);
+      for (int i = 1; i <= 10; i++)
+         d.push_front(-i);
+      for (int i = 0; i < num - 10; i++)
+         d.push_back(i);
+      assertUnit(d.numBlocks == static_cast<size_t>(num));
+      assertUnit(d.isMapped(d.numBlocks));
+      // exercise
+      d.push_back(num - 10);
+      // verify
+      //   [0 1 2 ... N-11 N-10 |    ...    | -10 ... -1]
+      assertUnit(d.numBlocks == static_cast<size_t>(2 * num));
+      assertUnit(d.iaFront == 2 * num - 10);
+      assertUnit(d.data[num - 10] != nullptr);
+      assertUnit(d.data[num - 9] == nullptr);
+      assertUnit(d.data[num - 1] == nullptr);
+      assertUnit(d.data[2 * num - 10] != nullptr);
+      assertUnit(d.size() == static_cast<size_t>(num + 1));
+      for (int i = 0; i < 10; i++)
+         assertUnit(d[i] == i - 10);
+      for (int i = 10; i <= num; i++)
+         assertUnit(d[i] == i - 10);
+   }
+
+   // a mapped map grows in place; the back's short run moves after the old end
+   void test_realloc_mappedMoveBack()
+   {  // setup
+      //   [0 ... 9 | -(N-10) ... -1]
+      custom::deque<int> d;
+      d.numCells = 1;
+      int num = DEQUE_MREMAP_THRESHOLD / static_cast<int>(sizeof(int *));
+      d.reserve(num);
+      for (int i = 1; i <= num - 10; i++)
+         d.push_front(-i);
+      for (int i = 0; i < 10; i++)
+         d.push_back(i);
+      // exercise
+      d.push_back(10);
+      // verify
+      //   [ | -(N-10) ... -1 | 0 ... 10 | ... ]
+      assertUnit(d.numBlocks == static_cast<size_t>(2 * num));
+      assertUnit(d.iaFront == 10);
+      assertUnit(d.data[0] == nullptr);
+      assertUnit(d.data[9] == nullptr);
+      assertUnit(d.data[num + 10] != nullptr);
+      assertUnit(d.size() == static_cast<size_t>(num + 1));
+      for (int i = 0; i < num - 10; i++)
+         assertUnit(d[i] == i - (num - 10));
+      for (int i = 0; i <= 10; i++)
+         assertUnit(d[num - 10 + i] == i);
+   }
+#endif // DEQUE_MREMAP_THRESHOLD
+
+   // a chunked map grows by rotating its directory; the chunks stay put
+   void test_realloc_chunkedRotate()
+   {  // setup
+      //   chunks [0 1 2 3 | -4 -3 -2 -1]
+      custom::deque<int, std::allocator<int>, custom::with_map<custom::map_chunked<4>>> d;
+      d.numCells = 1;
+      d.reserve(8);
+      for (int i = 1; i <= 4; i++)
+         d.push_front(-i);
+      for (int i = 0; i < 4; i++)
+         d.push_back(i);
+      assertUnit(d.numBlocks == 8);
+      assertUnit(d.iaFront == 4);
+      int ** chunk0 = d.data.chunks[0];
+      int ** chunk1 = d.data.chunks[1];
+      // exercise
+      d.push_back(4);
+      // verify
+      //   chunks [-4 -3 -2 -1 | 0 1 2 3 | 4 _ _ _ | _ _ _ _]
+      assertUnit(d.numBlocks == 16);
+      assertUnit(d.iaFront == 0);
+      assertUnit(d.data.chunks[0] == chunk1);
+      assertUnit(d.data.chunks[1] == chunk0);
+      assertUnit(d.data[8] != nullptr);
+      assertUnit(d.data[9] == nullptr);
+      assertUnit(d.data[15] == nullptr);
+      assertUnit(d.size() == 9);
+      for (int i = 0; i < 9; i++)
+         assertUnit(d[i] == i - 4);
+   }
+
+   // the back's blocks in the front's chunk move to the first new chunk
+   void test_realloc_chunkedSharedChunk()
+   {  // setup
+      //   chunks [0 1 -6 -5 | -4 -3 -2 -1]
+      custom::deque<int, std::allocator<int>, custom::with_map<custom::map_chunked<4>>> d;
+      d.numCells = 1;
+      d.reserve(8);
+      for (int i = 1; i <= 6; i++)
+         d.push_front(-i);
+      for (int i = 0; i < 2; i++)
+         d.push_back(i);
+      assertUnit(d.iaFront == 2);
+      int * pBlock0 = d.data[0];
+      int * pBlock1 = d.data[1];
+      // exercise
+      d.push_back(2);
+      // verify
+      //   chunks [_ _ -6 -5 | -4 -3 -2 -1 | 0 1 2 _ | _ _ _ _]
+      assertUnit(d.numBlocks == 16);
+      assertUnit(d.iaFront == 2);
+      assertUnit(d.data[0] == nullptr);
+      assertUnit(d.data[1] == nullptr);
+      assertUnit(d.data[8] == pBlock0);
+      assertUnit(d.data[9] == pBlock1);
+      assertUnit(d.data[10] != nullptr);
+      assertUnit(d.size() == 9);
+      for (int i = 0; i < 9; i++)
+         assertUnit(d[i] == i - 6);
+   }
+
 
    /***************************************
     * CONSTRUCTORS
@@ -656,7 +888,7 @@ public:
       d.data = (Spy **)0xBAADF00D;
       Spy::reset();
       // exercise
-      alloc.construct(&d);  // just call the constructor by itself
+      construct(alloc, &d);  // just call the constructor by itself
       // verify
       assertUnit(Spy::numAssign() == 0);     
       assertUnit(Spy::numAlloc() == 0);
@@ -670,6 +902,70 @@ public:
       assertEmptyFixture(d);
    }  // teardown
 
+   // capacity hint: every block allocated and the front placed between them
+   void test_construct_hint()
+   {  // setup
+      typedef custom::deque<Spy, CountingAllocator<Spy>> CountingDeque;
+      Spy::reset();
+      // exercise
+      CountingDeque d(custom::capacity_hint(64, 16));
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(d.numElements == 0);
+      assertUnit(d.numCells == 16);
+      assertUnit(d.numBlocks == 4);
+      assertUnit(d.iaFront == 16);
+      assertUnit(d.alloc.numAllocate == 4);
+      for (int ib = 0; ib < 4; ib++)
+         assertUnit(d.data[ib] != nullptr);
+      // exercise
+      Spy** data = d.data;
+      for (int i = 0; i < 48; i++)
+         d.push_back(Spy(i));
+      for (int i = 1; i <= 16; i++)
+         d.push_front(Spy(-i));
+      // verify
+      assertUnit(d.data == data);
+      assertUnit(d.numBlocks == 4);
+      assertUnit(d.alloc.numAllocate == 4);
+      assertUnit(d.size() == 64);
+      assertUnit(d.front() == Spy(-16));
+      assertUnit(d[16] == Spy(0));
+      assertUnit(d.back() == Spy(47));
+   }  // teardown
+
+   // growing past the hint keeps the blocks that are not in use yet
+   void test_construct_hintSpareBlocks()
+   {  // setup
+      typedef custom::deque<Spy, CountingAllocator<Spy>> CountingDeque;
+      CountingDeque d(custom::capacity_hint(64));
+      d.push_back(Spy(0));
+      // exercise
+      d.reserve(200);
+      // verify
+      assertUnit(d.numBlocks == 13);
+      assertUnit(d.alloc.numAllocate == 4);
+      assertUnit(d.alloc.numDeallocate == 0);
+      int numBlocksAllocated = 0;
+      for (int ib = 0; ib < 13; ib++)
+         if (d.data[ib] != nullptr)
+            numBlocksAllocated++;
+      assertUnit(numBlocksAllocated == 4);
+      assertUnit(d.front() == Spy(0));
+      // exercise
+      for (int i = 1; i < 200; i++)
+         d.push_back(Spy(i));
+      // verify
+      assertUnit(d.numBlocks == 13);
+      assertUnit(d.alloc.numAllocate == 13);
+      assertUnit(d.alloc.numDeallocate == 0);
+      for (int i = 0; i < 200; i++)
+         assertUnit(d[i] == Spy(i));
+      d.clear();
+      assertUnit(d.alloc.numDeallocate == 13);
+   }  // teardown
+
    /***************************************
     * SIZE EMPTY CAPACITY
     ***************************************/
@@ -779,6 +1075,66 @@ public:
       // teardown
       teardownStandardFixture(d);
    }
+   // trim frees the blocks that hold nothing and keeps the map
+   void test_trim_spares()
+   {  // setup
+      //    [    ][0..15][16..19][    ]
+      custom::deque<Spy> d(custom::capacity_hint(64, 16));
+      for (int i = 0; i < 20; i++)
+         d.push_back(Spy(i));
+      Spy** data = d.data;
+      Spy::reset();
+      // exercise
+      size_t numFreed = d.trim();
+      // verify
+      assertUnit(numFreed == 2);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(d.data == data);
+      assertUnit(d.numBlocks == 4);
+      assertUnit(d.data[0] == nullptr);
+      assertUnit(d.data[1] != nullptr);
+      assertUnit(d.data[2] != nullptr);
+      assertUnit(d.data[3] == nullptr);
+      assertUnit(d.size() == 20);
+      for (int i = 0; i < 20; i++)
+         assertUnit(d[i] == Spy(i));
+      // growing back into the map allocates blocks again
+      for (int i = 20; i < 48; i++)
+         d.push_back(Spy(i));
+      assertUnit(d.data == data);
+      assertUnit(d.data[3] != nullptr);
+      assertUnit(d.back() == Spy(47));
+   }  // teardown
+
+   // the spares kept are the ones the back grows into next
+   void test_trim_keepNearBack()
+   {  // setup
+      custom::deque<Spy> d(custom::capacity_hint(64, 16));
+      for (int i = 0; i < 20; i++)
+         d.push_back(Spy(i));
+      // exercise
+      size_t numFreed = d.trim(1);
+      // verify
+      assertUnit(numFreed == 1);
+      assertUnit(d.data[0] == nullptr);
+      assertUnit(d.data[3] != nullptr);
+      assertUnit(d.size() == 20);
+   }  // teardown
+
+   // an empty deque with blocks gives them all back
+   void test_trim_empty()
+   {  // setup
+      custom::deque<Spy> d(custom::capacity_hint(64));
+      // exercise
+      size_t numFreed = d.trim();
+      // verify
+      assertUnit(numFreed == 4);
+      assertUnit(d.numBlocks == 4);
+      for (int ib = 0; ib < 4; ib++)
+         assertUnit(d.data[ib] == nullptr);
+      assertUnit(d.trim() == 0);
+   }  // teardown
+
 
 
    /***************************************
@@ -880,9 +1236,9 @@ public:
       dSrc.data[4] = nullptr;
       dSrc.data[5] = nullptr;
       dSrc.data[6] = dSrc.alloc.allocate(dSrc.numCells);
-      dSrc.alloc.construct(&dSrc.data[6][2], Spy(59));
-      dSrc.alloc.construct(&dSrc.data[0][0], Spy(67));
-      dSrc.alloc.construct(&dSrc.data[0][1], Spy(79));
+      construct(dSrc.alloc, &dSrc.data[6][2], Spy(59));
+      construct(dSrc.alloc, &dSrc.data[0][0], Spy(67));
+      construct(dSrc.alloc, &dSrc.data[0][1], Spy(79));
       dSrc.iaFront = 20;
       Spy::reset();
       // exercise
@@ -1093,9 +1449,9 @@ public:
       dSrc.data[4] = nullptr;
       dSrc.data[5] = nullptr;
       dSrc.data[6] = dSrc.alloc.allocate(dSrc.numCells);
-      dSrc.alloc.construct(&dSrc.data[6][2], Spy(59));
-      dSrc.alloc.construct(&dSrc.data[0][0], Spy(67));
-      dSrc.alloc.construct(&dSrc.data[0][1], Spy(79));
+      construct(dSrc.alloc, &dSrc.data[6][2], Spy(59));
+      construct(dSrc.alloc, &dSrc.data[0][0], Spy(67));
+      construct(dSrc.alloc, &dSrc.data[0][1], Spy(79));
       dSrc.iaFront = 20;
       custom::deque<Spy> dDes;
       Spy::reset();
@@ -1135,6 +1491,78 @@ public:
    }
 
    
+   // refill with fewer elements: overwrite, then drop the tail
+   void test_assignfill_shrink()
+   {  // setup
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 49 |  | 55 | 67 |    |
+      //    +----+----+----+  +----+----+----+
+      custom::deque<Spy> d;
+      setupStandardFixture(d);
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      d.assign(2, s);
+      // verify
+      assertUnit(Spy::numAssign() == 2);        // assign 99 over 31, 49
+      assertUnit(Spy::numDestructor() == 2);    // destroy 55, 67
+      assertUnit(Spy::numDelete() == 2);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      //      0     1    2
+      //    +----+----+----+
+      //    |    | 99 | 99 |
+      //    +----+----+----+
+      assertUnit(d.numElements == 2);
+      assertUnit(d.iaFront == 4);
+      assertUnit(d.numBlocks == 4);
+      assertUnit(d.data[1] != nullptr);
+      assertUnit(d.data[2] == nullptr);
+      if (d.data[1])
+      {
+         assertUnit(d.data[1][1] == Spy(99));
+         assertUnit(d.data[1][2] == Spy(99));
+      }
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // refill with more elements: overwrite, then grow into the back block
+   void test_assignrange_grow()
+   {  // setup
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 49 |  | 55 | 67 |    |
+      //    +----+----+----+  +----+----+----+
+      custom::deque<Spy> d;
+      setupStandardFixture(d);
+      Spy* pBlock2 = d.data[2];
+      Spy values[] = { Spy(10), Spy(11), Spy(12), Spy(13), Spy(14), Spy(15) };
+      Spy::reset();
+      // exercise
+      d.assign(values, values + 6);
+      // verify
+      assertUnit(Spy::numAssign() == 4);        // assign 10, 11, 12, 13
+      assertUnit(Spy::numCopy() == 2);          // copy-construct 14, 15
+      assertUnit(Spy::numAlloc() == 2);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      //      0     1    2       0    1    2       0    1    2
+      //    +----+----+----+  +----+----+----+  +----+----+----+
+      //    |    | 10 | 11 |  | 12 | 13 | 14 |  | 15 |    |    |
+      //    +----+----+----+  +----+----+----+  +----+----+----+
+      assertUnit(d.numElements == 6);
+      assertUnit(d.iaFront == 4);
+      assertUnit(d.numBlocks == 4);
+      assertUnit(d.data[2] == pBlock2);
+      for (int i = 0; i < 6; i++)
+         assertUnit(d[i] == Spy(10 + i));
+      // teardown
+      teardownStandardFixture(d);
+   }
+
    /***************************************
     * CLEAR
     ***************************************/
@@ -1289,7 +1717,7 @@ public:
          if (d.data[2] && d.numElements == 5)
          {
             assertUnit(d.data[2][2] == Spy(99));
-            d.alloc.destroy(&d.data[2][2]);
+            destroy(d.alloc, &d.data[2][2]);
             d.numElements = 4;
          }
       }
@@ -1343,14 +1771,14 @@ public:
          if (d.data[2])
          {
             assertUnit(d.data[2][2] == Spy(79));
-            d.alloc.destroy(&d.data[2][2]);
+            destroy(d.alloc, &d.data[2][2]);
             d.numElements--;
          }
          assertUnit(d.data[3] != nullptr);
          if (d.data[3])
          {
             assertUnit(d.data[3][0] == Spy(99));
-            d.alloc.destroy(&d.data[3][0]);
+            destroy(d.alloc, &d.data[3][0]);
             d.numElements--;
             d.alloc.deallocate(d.data[3], d.numCells);
             d.data[3] = nullptr;
@@ -1379,8 +1807,8 @@ public:
       d.numBlocks = 1;
       d.data = new Spy * [1];
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][2], Spy(11));
-      d.alloc.construct(&d.data[0][3], Spy(28));
+      construct(d.alloc, &d.data[0][2], Spy(11));
+      construct(d.alloc, &d.data[0][3], Spy(28));
       Spy * pBlock = d.data[0];
       d.iaFront = 2;
       Spy s(99);
@@ -1445,14 +1873,14 @@ public:
       d.data[0] = d.alloc.allocate(d.numCells);
       d.data[1] = d.alloc.allocate(d.numCells);
       d.data[2] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[1][1], Spy(11));
-      d.alloc.construct(&d.data[1][2], Spy(28));
-      d.alloc.construct(&d.data[2][0], Spy(31));
-      d.alloc.construct(&d.data[2][1], Spy(49));
-      d.alloc.construct(&d.data[2][2], Spy(59));
-      d.alloc.construct(&d.data[0][0], Spy(67));
-      d.alloc.construct(&d.data[0][1], Spy(79));
-      d.alloc.construct(&d.data[0][2], Spy(85));
+      construct(d.alloc, &d.data[1][1], Spy(11));
+      construct(d.alloc, &d.data[1][2], Spy(28));
+      construct(d.alloc, &d.data[2][0], Spy(31));
+      construct(d.alloc, &d.data[2][1], Spy(49));
+      construct(d.alloc, &d.data[2][2], Spy(59));
+      construct(d.alloc, &d.data[0][0], Spy(67));
+      construct(d.alloc, &d.data[0][1], Spy(79));
+      construct(d.alloc, &d.data[0][2], Spy(85));
       d.iaFront = 4;
       Spy* pFirstBlock  = d.data[0];
       Spy* pSecondBlock = d.data[1];
@@ -1603,7 +2031,7 @@ public:
          if (d.data[1] && d.numElements == 5)
          {
             assertUnit(d.data[1][0] == Spy(99));
-            d.alloc.destroy(&d.data[1][0]);
+            destroy(d.alloc, &d.data[1][0]);
             d.numElements = 4;
             d.iaFront = 4;
          }
@@ -1662,7 +2090,7 @@ public:
          if (d.data[0])
          {
             assertUnit(d.data[0][2] == Spy(99));
-            d.alloc.destroy(&d.data[0][2]);
+            destroy(d.alloc, &d.data[0][2]);
             d.alloc.deallocate(d.data[0], d.numCells);
             d.data[0] = nullptr;
             d.iaFront++;
@@ -1671,7 +2099,7 @@ public:
          if (d.data[1])
          {
             assertUnit(d.data[1][0] == Spy(28));
-            d.alloc.destroy(&d.data[1][0]);
+            destroy(d.alloc, &d.data[1][0]);
             d.numElements--;
             d.iaFront++;
          }
@@ -1700,8 +2128,8 @@ public:
       d.numBlocks = 1;
       d.data = new Spy * [1];
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][0], Spy(11));
-      d.alloc.construct(&d.data[0][1], Spy(28));
+      construct(d.alloc, &d.data[0][0], Spy(11));
+      construct(d.alloc, &d.data[0][1], Spy(28));
       Spy* pBlock = d.data[0];
       d.iaFront = 0;
       Spy s(99);
@@ -1769,14 +2197,14 @@ public:
       d.data[0] = d.alloc.allocate(d.numCells);
       d.data[1] = d.alloc.allocate(d.numCells);
       d.data[2] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[1][0], Spy(5));
-      d.alloc.construct(&d.data[1][1], Spy(11));
-      d.alloc.construct(&d.data[1][2], Spy(28));
-      d.alloc.construct(&d.data[2][0], Spy(31));
-      d.alloc.construct(&d.data[2][1], Spy(49));
-      d.alloc.construct(&d.data[2][2], Spy(59));
-      d.alloc.construct(&d.data[0][0], Spy(67));
-      d.alloc.construct(&d.data[0][1], Spy(79));
+      construct(d.alloc, &d.data[1][0], Spy(5));
+      construct(d.alloc, &d.data[1][1], Spy(11));
+      construct(d.alloc, &d.data[1][2], Spy(28));
+      construct(d.alloc, &d.data[2][0], Spy(31));
+      construct(d.alloc, &d.data[2][1], Spy(49));
+      construct(d.alloc, &d.data[2][2], Spy(59));
+      construct(d.alloc, &d.data[0][0], Spy(67));
+      construct(d.alloc, &d.data[0][1], Spy(79));
       d.iaFront = 3;
       Spy* pFirstBlock = d.data[0];
       Spy* pSecondBlock = d.data[1];
@@ -1864,8 +2292,8 @@ public:
       d.data[4] = nullptr;
       d.data[5] = nullptr;
       d.data[6] = nullptr;
-      d.alloc.construct(&d.data[0][0], Spy(67));
-      d.alloc.construct(&d.data[0][1], Spy(79));
+      construct(d.alloc, &d.data[0][0], Spy(67));
+      construct(d.alloc, &d.data[0][1], Spy(79));
       d.iaFront = 0;
       Spy* pBlock = d.data[0];
       Spy s(99);
@@ -1918,6 +2346,147 @@ public:
       teardownStandardFixture(d);
    }
 
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // insert into the front half: shift the front toward a new front slot
+   void test_insert_frontHalf()
+   {  // setup
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 49 |  | 55 | 67 |    |
+      //    +----+----+----+  +----+----+----+
+      //               \        /
+      //          +----+----+----+----+
+      //          | // |    |    | // |
+      //          +----+----+----+----+
+      custom::deque<Spy> d;
+      setupStandardFixture(d);
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      auto it = d.insert(custom::deque<Spy>::iterator(1, &d), s);
+      // verify
+      assertUnit(Spy::numCopy() == 1);       // copy 99
+      assertUnit(Spy::numAlloc() == 1);      // allocate 99
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    | 31 | 99 | 49 |  | 55 | 67 |    |
+      //    +----+----+----+  +----+----+----+
+      //               \        /
+      //          +----+----+----+----+
+      //          | // |    |    | // |
+      //          +----+----+----+----+
+      assertUnit(it.id == 1);
+      assertUnit(d.numElements == 5);
+      assertUnit(d.iaFront == 3);
+      assertUnit(d.numBlocks == 4);
+      assertUnit(d.data != nullptr);
+      if (d.data && d.data[1] && d.data[2])
+      {
+         assertUnit(d.data[1][0] == Spy(31));
+         assertUnit(d.data[1][1] == Spy(99));
+         assertUnit(d.data[1][2] == Spy(49));
+         assertUnit(d.data[2][0] == Spy(55));
+         assertUnit(d.data[2][1] == Spy(67));
+      }
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // insert into the back half: shift the back toward a new back slot
+   void test_insert_backHalf()
+   {  // setup
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 49 |  | 55 | 67 |    |
+      //    +----+----+----+  +----+----+----+
+      //               \        /
+      //          +----+----+----+----+
+      //          | // |    |    | // |
+      //          +----+----+----+----+
+      custom::deque<Spy> d;
+      setupStandardFixture(d);
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      auto it = d.insert(custom::deque<Spy>::iterator(3, &d), s);
+      // verify
+      assertUnit(Spy::numCopy() == 1);       // copy 99
+      assertUnit(Spy::numAlloc() == 1);      // allocate 99
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 49 |  | 55 | 99 | 67 |
+      //    +----+----+----+  +----+----+----+
+      //               \        /
+      //          +----+----+----+----+
+      //          | // |    |    | // |
+      //          +----+----+----+----+
+      assertUnit(it.id == 3);
+      assertUnit(d.numElements == 5);
+      assertUnit(d.iaFront == 4);
+      assertUnit(d.numBlocks == 4);
+      assertUnit(d.data != nullptr);
+      if (d.data && d.data[1] && d.data[2])
+      {
+         assertUnit(d.data[1][1] == Spy(31));
+         assertUnit(d.data[1][2] == Spy(49));
+         assertUnit(d.data[2][0] == Spy(55));
+         assertUnit(d.data[2][1] == Spy(99));
+         assertUnit(d.data[2][2] == Spy(67));
+      }
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // insert a relocatable element: the back half slides by memmove
+   void test_insert_relocate()
+   {  // setup
+      //    +----+----+----+  +----+----+----+
+      //    | 31 | 49 | 55 |  | 67 |    |    |
+      //    +----+----+----+  +----+----+----+
+      custom::deque<RelocatableSpy> d;
+      d.numCells = 3;
+      d.push_back(RelocatableSpy(31));
+      d.push_back(RelocatableSpy(49));
+      d.push_back(RelocatableSpy(55));
+      d.push_back(RelocatableSpy(67));
+      RelocatableSpy s(99);
+      Spy::reset();
+      // exercise
+      d.insert(custom::deque<RelocatableSpy>::iterator(2, &d), s);
+      // verify
+      assertUnit(Spy::numCopy() == 1);       // copy 99
+      assertUnit(Spy::numAlloc() == 1);      // allocate 99
+      assertUnit(Spy::numCopyMove() == 1);   // move 99 into its slot
+      assertUnit(Spy::numDestructor() == 1); // destroy the moved-from copy
+      assertUnit(Spy::numAssignMove() == 0); // 55 and 67 relocate untouched
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      //    +----+----+----+  +----+----+----+
+      //    | 31 | 49 | 99 |  | 55 | 67 |    |
+      //    +----+----+----+  +----+----+----+
+      assertUnit(d.numElements == 5);
+      assertUnit(d.iaFront == 0);
+      if (d.data && d.data[0] && d.data[1])
+      {
+         assertUnit(d.data[0][0] == Spy(31));
+         assertUnit(d.data[0][1] == Spy(49));
+         assertUnit(d.data[0][2] == Spy(99));
+         assertUnit(d.data[1][0] == Spy(55));
+         assertUnit(d.data[1][1] == Spy(67));
+      }
+   }  // teardown
+
    /***************************************
     * POP FRONT
     ***************************************/
@@ -1967,7 +2536,7 @@ public:
          assertUnit(d.data[1] != nullptr);
          if (d.data[1])
          {
-            d.alloc.construct(&d.data[1][1], Spy(31));
+            construct(d.alloc, &d.data[1][1], Spy(31));
             d.iaFront--;
             d.numElements++;
          }
@@ -1995,9 +2564,9 @@ public:
       d.numBlocks = 1;
       d.data = new Spy * [1];
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][3], Spy(11));
-      d.alloc.construct(&d.data[0][0], Spy(28));
-      d.alloc.construct(&d.data[0][1], Spy(31));
+      construct(d.alloc, &d.data[0][3], Spy(11));
+      construct(d.alloc, &d.data[0][0], Spy(28));
+      construct(d.alloc, &d.data[0][1], Spy(31));
       Spy* pBlock = d.data[0];
       d.iaFront = 3;
       Spy::reset();
@@ -2057,7 +2626,7 @@ public:
       d.numBlocks = 1;
       d.data = new Spy * [1];
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][1], Spy(31));
+      construct(d.alloc, &d.data[0][1], Spy(31));
       d.iaFront = 1;
       Spy::reset();
       // exercise
@@ -2100,7 +2669,7 @@ public:
       //          +----+----+----+----+
       custom::deque<Spy> d;
       setupStandardFixture(d);
-      d.alloc.destroy(&d.data[1][1]);
+      destroy(d.alloc, &d.data[1][1]);
       d.iaFront++;
       d.numElements--;
       Spy::reset();
@@ -2170,9 +2739,9 @@ public:
       d.data[4] = nullptr;
       d.data[5] = nullptr;
       d.data[6] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[6][2], Spy(59));
-      d.alloc.construct(&d.data[0][0], Spy(67));
-      d.alloc.construct(&d.data[0][1], Spy(79));
+      construct(d.alloc, &d.data[6][2], Spy(59));
+      construct(d.alloc, &d.data[0][0], Spy(67));
+      construct(d.alloc, &d.data[0][1], Spy(79));
       d.iaFront = 20;
       Spy* pBlock = d.data[0];
       Spy::reset();
@@ -2220,14 +2789,9 @@ public:
       teardownStandardFixture(d);
    }
 
-   /***************************************
-    * POP BACK
-    ***************************************/
-   
-    // remove one element from a standard fixture
-   void test_popback_standard()
+   // drain part of the standard fixture into a buffer
+   void test_popfrontinto_standard()
    {  // setup
-      //         iaFront
       //      0     1    2       0    1    2
       //    +----+----+----+  +----+----+----+
       //    |    | 31 | 49 |  | 55 | 67 |    |
@@ -2238,27 +2802,217 @@ public:
       //          +----+----+----+----+
       custom::deque<Spy> d;
       setupStandardFixture(d);
+      Spy* pBlock = d.data[2];
+      Spy out[3];
       Spy::reset();
       // exercise
-      d.pop_back();
+      size_t num = d.pop_front_into(out, 3);
       // verify
-      assertUnit(Spy::numDelete() == 1);        // delete 67
-      assertUnit(Spy::numDestructor() == 1);    // destroy 67
+      assertUnit(num == 3);
+      assertUnit(Spy::numAssignMove() == 3);    // move 31, 49, 55
+      assertUnit(Spy::numDestructor() == 3);    // destroy moved-from 31, 49, 55
+      assertUnit(Spy::numDelete() == 0);        // the values changed hands
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numAssign() == 0);
-      assertUnit(Spy::numDefault() == 0);
-      assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
-      assertUnit(Spy::numAssignMove() == 0);
-      //             iaFront
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 |    |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
+      assertUnit(out[0] == Spy(31));
+      assertUnit(out[1] == Spy(49));
+      assertUnit(out[2] == Spy(55));
+      //                       iaFront
+      //                         0    1    2
+      //                      +----+----+----+
+      //                      |    | 67 |    |
+      //                      +----+----+----+
+      //                        /
+      //          +----+----+----+----+
+      //          | // | // |    | // |
+      //          +----+----+----+----+
+      assertUnit(d.numElements == 1);
+      assertUnit(d.iaFront == 7);
+      assertUnit(d.numBlocks == 4);
+      assertUnit(d.numCells == 3);
+      assertUnit(d.data != nullptr);
+      if (d.data)
+      {
+         assertUnit(d.data[0] == nullptr);
+         assertUnit(d.data[1] == nullptr);
+         assertUnit(d.data[2] == pBlock);
+         if (d.data[2])
+            assertUnit(d.data[2][1] == Spy(67));
+         assertUnit(d.data[3] == nullptr);
+      }
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // ask for more than there is from a deque that wraps
+   void test_popfrontinto_wrappedAll()
+   {  // setup
+      //                                iaFront
+      //   +----+----+----+    +----+----+----+
+      //   | 67 | 79 |    |    |    |    | 59 |
+      //   +----+----+----+    +----+----+----+
+      //     |                             |
+      //   +----+----+----+----+----+----+----+
+      //   |    | // | // | // | // | // |    |
+      //   +----+----+----+----+----+----+----+
+      custom::deque<Spy> d;
+      d.numCells = 3;
+      d.numElements = 3;
+      d.numBlocks = 7;
+      d.data = new Spy * [7];
+      d.data[0] = d.alloc.allocate(d.numCells);
+      d.data[1] = nullptr;
+      d.data[2] = nullptr;
+      d.data[3] = nullptr;
+      d.data[4] = nullptr;
+      d.data[5] = nullptr;
+      d.data[6] = d.alloc.allocate(d.numCells);
+      construct(d.alloc, &d.data[6][2], Spy(59));
+      construct(d.alloc, &d.data[0][0], Spy(67));
+      construct(d.alloc, &d.data[0][1], Spy(79));
+      d.iaFront = 20;
+      Spy out[5];
+      Spy::reset();
+      // exercise
+      size_t num = d.pop_front_into(out, 5);
+      // verify
+      assertUnit(num == 3);
+      assertUnit(Spy::numAssignMove() == 3);    // move 59, 67, 79
+      assertUnit(Spy::numDestructor() == 3);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(out[0] == Spy(59));
+      assertUnit(out[1] == Spy(67));
+      assertUnit(out[2] == Spy(79));
+      assertUnit(out[3].empty());
+      assertUnit(out[4].empty());
+      assertUnit(d.numElements == 0);
+      assertUnit(d.numBlocks == 7);
+      assertUnit(d.data != nullptr);
+      if (d.data)
+         for (int ib = 0; ib < 7; ib++)
+            assertUnit(d.data[ib] == nullptr);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // trivially copyable elements are copied a block segment at a time
+   void test_popfrontinto_trivial()
+   {  // setup
+      custom::deque<int> d;
+      d.numCells = 4;
+      for (int i = 0; i < 10; i++)
+         d.push_front(i);
+      int out[7] = {};
+      // exercise
+      size_t num = d.pop_front_into(out, 7);
+      // verify
+      assertUnit(num == 7);
+      for (int i = 0; i < 7; i++)
+         assertUnit(out[i] == 9 - i);
+      assertUnit(d.size() == 3);
+      assertUnit(d.front() == 2);
+      assertUnit(d.back() == 0);
+      d.push_front(99);
+      assertUnit(d.front() == 99);
+      assertUnit(d[3] == 0);
+   }  // teardown
+
+   // drain the back, a block segment at a time, freeing emptied blocks
+   void test_popbackinto_standard()
+   {  // setup
+      //    [0, 1, 2, 3][4, 5, 6, 7][8, 9,  ,  ][  ,  ,  ,  ]
+      custom::deque<Spy> d;
+      d.numCells = 4;
+      for (int i = 0; i < 10; i++)
+         d.push_back(Spy(i));
+      Spy out[7];
+      Spy::reset();
+      // exercise
+      size_t num = d.pop_back_into(out, 7);
+      // verify
+      //    [0, 1, 2,  ][  ,  ,  ,  ][  ,  ,  ,  ][  ,  ,  ,  ]
+      assertUnit(num == 7);
+      assertUnit(Spy::numAssignMove() == 7);
+      assertUnit(Spy::numDestructor() == 7);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      for (int i = 0; i < 7; i++)
+         assertUnit(out[i] == Spy(9 - i));
+      assertUnit(d.size() == 3);
+      assertUnit(d.back() == Spy(2));
+      assertUnit(d.data[0] != nullptr);
+      assertUnit(d.data[1] == nullptr);
+      assertUnit(d.data[2] == nullptr);
+      // exercise
+      d.push_back(Spy(99));
+      // verify
+      assertUnit(d.back() == Spy(99));
+      assertUnit(d[2] == Spy(2));
+   }  // teardown
+
+   // ask for more than there is from a deque whose back wrapped
+   void test_popbackinto_wrappedAll()
+   {  // setup
+      custom::deque<int> d;
+      d.numCells = 4;
+      for (int i = 0; i < 3; i++)
+         d.push_back(i);
+      for (int i = 1; i <= 3; i++)
+         d.push_front(-i);
+      int out[10] = {};
+      // exercise
+      size_t num = d.pop_back_into(out, 10);
+      // verify
+      assertUnit(num == 6);
+      for (int i = 0; i < 6; i++)
+         assertUnit(out[i] == 2 - i);
+      assertUnit(d.empty());
+      for (size_t ib = 0; ib < d.numBlocks; ib++)
+         assertUnit(d.data[ib] == nullptr);
+   }  // teardown
+
+   /***************************************
+    * POP BACK
+    ***************************************/
+   
+    // remove one element from a standard fixture
+   void test_popback_standard()
+   {  // setup
+      //         iaFront
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 49 |  | 55 | 67 |    |
+      //    +----+----+----+  +----+----+----+
+      //               \        /
+      //          +----+----+----+----+
+      //          | // |    |    | // |
+      //          +----+----+----+----+
+      custom::deque<Spy> d;
+      setupStandardFixture(d);
+      Spy::reset();
+      // exercise
+      d.pop_back();
+      // verify
+      assertUnit(Spy::numDelete() == 1);        // delete 67
+      assertUnit(Spy::numDestructor() == 1);    // destroy 67
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      //             iaFront
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 49 |  | 55 |    |    |
+      //    +----+----+----+  +----+----+----+
+      //               \        /
+      //          +----+----+----+----+
+      //          | // |    |    | // |
       //          +----+----+----+----+
       assertUnit(d.numElements == 3);
       assertUnit(d.data != nullptr);
@@ -2267,7 +3021,7 @@ public:
          assertUnit(d.data[2] != nullptr);
          if (d.data[2])
          {
-            d.alloc.construct(&d.data[2][1], Spy(67));
+            construct(d.alloc, &d.data[2][1], Spy(67));
             d.numElements++;
          }
       }
@@ -2294,8 +3048,8 @@ public:
       d.numBlocks = 1;
       d.data = new Spy * [1];
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][2], Spy(11));
-      d.alloc.construct(&d.data[0][3], Spy(28));
+      construct(d.alloc, &d.data[0][2], Spy(11));
+      construct(d.alloc, &d.data[0][3], Spy(28));
       Spy* pBlock = d.data[0];
       d.iaFront = 2;
       Spy::reset();
@@ -2354,7 +3108,7 @@ public:
       d.numBlocks = 1;
       d.data = new Spy * [1];
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][1], Spy(31));
+      construct(d.alloc, &d.data[0][1], Spy(31));
       d.iaFront = 1;
       Spy::reset();
       // exercise
@@ -2397,7 +3151,7 @@ public:
       //          +----+----+----+----+
       custom::deque<Spy> d;
       setupStandardFixture(d);
-      d.alloc.destroy(&d.data[2][1]);
+      destroy(d.alloc, &d.data[2][1]);
       d.numElements--;
       Spy::reset();
       // exercise
@@ -2465,57 +3219,501 @@ public:
       d.data[4] = nullptr;
       d.data[5] = nullptr;
       d.data[6] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[6][1], Spy(59));
-      d.alloc.construct(&d.data[6][2], Spy(67));
-      d.alloc.construct(&d.data[0][0], Spy(79));
+      construct(d.alloc, &d.data[6][1], Spy(59));
+      construct(d.alloc, &d.data[6][2], Spy(67));
+      construct(d.alloc, &d.data[0][0], Spy(79));
       d.iaFront = 19;
       Spy* pBlock = d.data[6];
       Spy::reset();
       // exercise
-      d.pop_back();
+      d.pop_back();
+      // verify
+      assertUnit(Spy::numDelete() == 1);        // delete 79
+      assertUnit(Spy::numDestructor() == 1);    // destroy 79
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      //   iaFront
+      //                            iaFront
+      //                       +----+----+----+
+      //                       |    | 59 | 67 |
+      //                       +----+----+----+
+      //                                   |
+      //   +----+----+----+----+----+----+----+
+      //   | // | // | // | // | // | // |    |
+      //   +----+----+----+----+----+----+----+
+      assertUnit(d.numElements == 2);
+      assertUnit(d.iaFront == 19);
+      assertUnit(d.numBlocks == 7);
+      assertUnit(d.numCells == 3);
+      assertUnit(d.data != nullptr);
+      if (d.data)
+      {
+         assertUnit(d.data[0] == nullptr);
+         assertUnit(d.data[1] == nullptr);
+         assertUnit(d.data[2] == nullptr);
+         assertUnit(d.data[3] == nullptr);
+         assertUnit(d.data[4] == nullptr);
+         assertUnit(d.data[5] == nullptr);
+         assertUnit(d.data[6] == pBlock);
+         if (d.data[6])
+         {
+            assertUnit(d.data[6][1] == Spy(59));
+            assertUnit(d.data[6][2] == Spy(67));
+         }
+      }
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+
+   /***************************************
+    * ERASE
+    ***************************************/
+
+   // erase from the front half: the front shifts back over the hole
+   void test_erase_frontHalf()
+   {  // setup
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 49 |  | 55 | 67 |    |
+      //    +----+----+----+  +----+----+----+
+      //               \        /
+      //          +----+----+----+----+
+      //          | // |    |    | // |
+      //          +----+----+----+----+
+      custom::deque<Spy> d;
+      setupStandardFixture(d);
+      Spy::reset();
+      // exercise
+      auto it = d.erase(custom::deque<Spy>::iterator(1, &d));
+      // verify
+      assertUnit(Spy::numDelete() == 1);     // delete 49
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    |    |    | 31 |  | 55 | 67 |    |
+      //    +----+----+----+  +----+----+----+
+      //               \        /
+      //          +----+----+----+----+
+      //          | // |    |    | // |
+      //          +----+----+----+----+
+      assertUnit(it.id == 1);
+      assertUnit(d.numElements == 3);
+      assertUnit(d.iaFront == 5);
+      assertUnit(d.data != nullptr);
+      if (d.data && d.data[1] && d.data[2])
+      {
+         assertUnit(d.data[1][2] == Spy(31));
+         assertUnit(d.data[2][0] == Spy(55));
+         assertUnit(d.data[2][1] == Spy(67));
+      }
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // erase from the back half: the back shifts forward over the hole
+   void test_erase_backHalf()
+   {  // setup
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 49 |  | 55 | 67 |    |
+      //    +----+----+----+  +----+----+----+
+      //               \        /
+      //          +----+----+----+----+
+      //          | // |    |    | // |
+      //          +----+----+----+----+
+      custom::deque<Spy> d;
+      setupStandardFixture(d);
+      Spy::reset();
+      // exercise
+      auto it = d.erase(custom::deque<Spy>::iterator(2, &d));
+      // verify
+      assertUnit(Spy::numDelete() == 1);     // delete 55
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 49 |  | 67 |    |    |
+      //    +----+----+----+  +----+----+----+
+      //               \        /
+      //          +----+----+----+----+
+      //          | // |    |    | // |
+      //          +----+----+----+----+
+      assertUnit(it.id == 2);
+      assertUnit(d.numElements == 3);
+      assertUnit(d.iaFront == 4);
+      assertUnit(d.data != nullptr);
+      if (d.data && d.data[1] && d.data[2])
+      {
+         assertUnit(d.data[1][1] == Spy(31));
+         assertUnit(d.data[1][2] == Spy(49));
+         assertUnit(d.data[2][0] == Spy(67));
+      }
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // erase a relocatable element: the front half slides by memmove
+   void test_erase_relocate()
+   {  // setup
+      //    +----+----+----+  +----+----+----+
+      //    | 31 | 49 | 55 |  | 67 |    |    |
+      //    +----+----+----+  +----+----+----+
+      custom::deque<RelocatableSpy> d;
+      d.numCells = 3;
+      d.push_back(RelocatableSpy(31));
+      d.push_back(RelocatableSpy(49));
+      d.push_back(RelocatableSpy(55));
+      d.push_back(RelocatableSpy(67));
+      Spy::reset();
+      // exercise
+      d.erase(custom::deque<RelocatableSpy>::iterator(1, &d));
+      // verify
+      assertUnit(Spy::numDestructor() == 1); // destroy 49
+      assertUnit(Spy::numDelete() == 1);     // delete 49
+      assertUnit(Spy::numCopyMove() == 0);   // 31 relocates untouched
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 55 |  | 67 |    |    |
+      //    +----+----+----+  +----+----+----+
+      assertUnit(d.numElements == 3);
+      assertUnit(d.iaFront == 1);
+      if (d.data && d.data[0] && d.data[1])
+      {
+         assertUnit(d.data[0][1] == Spy(31));
+         assertUnit(d.data[0][2] == Spy(55));
+         assertUnit(d.data[1][0] == Spy(67));
+      }
+   }  // teardown
+
+   /***************************************
+    * REMOVE IF and UNIQUE
+    ***************************************/
+
+   // survivors shift forward across a block boundary
+   void test_removeif_shiftSurvivors()
+   {  // setup
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 49 |  | 55 | 67 |    |
+      //    +----+----+----+  +----+----+----+
+      //               \        /
+      //          +----+----+----+----+
+      //          | // |    |    | // |
+      //          +----+----+----+----+
+      custom::deque<Spy> d;
+      setupStandardFixture(d);
+      Spy::reset();
+      // exercise
+      size_t num = custom::erase_if(d, [](const Spy & s) { return s.get() == 49; });
+      // verify
+      assertUnit(num == 1);
+      assertUnit(Spy::numAssignMove() == 2);    // move 55, 67 forward
+      assertUnit(Spy::numDelete() == 1);        // delete 49
+      assertUnit(Spy::numDestructor() == 1);    // destroy the moved-from 67
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 55 |  | 67 |    |    |
+      //    +----+----+----+  +----+----+----+
+      //               \        /
+      //          +----+----+----+----+
+      //          | // |    |    | // |
+      //          +----+----+----+----+
+      assertUnit(d.numElements == 3);
+      assertUnit(d.iaFront == 4);
+      assertUnit(d.data[1] != nullptr);
+      assertUnit(d.data[2] != nullptr);
+      if (d.data[1] && d.data[2])
+      {
+         assertUnit(d.data[1][1] == Spy(31));
+         assertUnit(d.data[1][2] == Spy(55));
+         assertUnit(d.data[2][0] == Spy(67));
+      }
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // removing the back of the deque frees its block
+   void test_removeif_freeBlock()
+   {  // setup
+      //      0     1    2       0    1    2
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 49 |  | 55 | 67 |    |
+      //    +----+----+----+  +----+----+----+
+      custom::deque<Spy> d;
+      setupStandardFixture(d);
+      Spy::reset();
+      // exercise
+      size_t num = d.remove_if([](const Spy & s) { return s.get() > 50; });
+      // verify
+      assertUnit(num == 2);
+      assertUnit(Spy::numDestructor() == 2);    // destroy 55, 67
+      assertUnit(Spy::numDelete() == 2);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      //      0     1    2
+      //    +----+----+----+
+      //    |    | 31 | 49 |
+      //    +----+----+----+
+      assertUnit(d.numElements == 2);
+      assertUnit(d.iaFront == 4);
+      assertUnit(d.data[1] != nullptr);
+      assertUnit(d.data[2] == nullptr);
+      if (d.data[1])
+      {
+         assertUnit(d.data[1][1] == Spy(31));
+         assertUnit(d.data[1][2] == Spy(49));
+      }
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // collapse runs of equal elements
+   void test_unique_runs()
+   {  // setup
+      custom::deque<int> d;
+      d.numCells = 4;
+      int values[] = { 1, 1, 2, 3, 3, 3, 3, 3, 1, 4, 4 };
+      for (int value : values)
+         d.push_back(value);
+      // exercise
+      size_t num = d.unique();
+      // verify
+      assertUnit(num == 6);
+      assertUnit(d.size() == 5);
+      int expected[] = { 1, 2, 3, 1, 4 };
+      for (int i = 0; i < 5; i++)
+         assertUnit(d[i] == expected[i]);
+      assertUnit(d.data[2] == nullptr);
+   }  // teardown
+
+   /***************************************
+    * SPLICE
+    ***************************************/
+
+   // move most of a deque into an empty one: whole blocks by pointer
+   void test_spliceback_empty()
+   {  // setup
+      //    [0, 1, 2, 3][4, 5, 6, 7][8, 9]
+      custom::deque<Spy> dSrc;
+      dSrc.numCells = 4;
+      for (int i = 0; i < 10; i++)
+         dSrc.push_back(Spy(i));
+      Spy* pBlock0 = dSrc.data[0];
+      Spy* pBlock1 = dSrc.data[1];
+      custom::deque<Spy> d;
+      d.numCells = 4;
+      Spy::reset();
+      // exercise
+      d.splice_back(dSrc, 9);
+      // verify
+      assertUnit(Spy::numCopyMove() == 1);      // move 8
+      assertUnit(Spy::numDestructor() == 1);    // destroy moved-from 8
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      //    [0, 1, 2, 3][4, 5, 6, 7][8]     [9]
+      assertUnit(d.size() == 9);
+      assertUnit(d.data[d.ibFromID(0)] == pBlock0);
+      assertUnit(d.data[d.ibFromID(4)] == pBlock1);
+      for (int i = 0; i < 9; i++)
+         assertUnit(d[i] == Spy(i));
+      assertUnit(dSrc.size() == 1);
+      assertUnit(dSrc.front() == Spy(9));
+      assertUnit(dSrc.data[0] == nullptr);
+      assertUnit(dSrc.data[1] == nullptr);
+   }  // teardown
+
+   // prepend onto a deque whose front is in the wrong cell
+   void test_splicefront_realign()
+   {  // setup
+      //    [0, 1, 2, 3][4, 5, 6, 7][8, 9]     [100]
+      custom::deque<Spy> dSrc;
+      dSrc.numCells = 4;
+      for (int i = 0; i < 10; i++)
+         dSrc.push_back(Spy(i));
+      Spy* pBlock1 = dSrc.data[1];
+      custom::deque<Spy> d;
+      d.numCells = 4;
+      d.push_back(Spy(100));
+      Spy::reset();
+      // exercise
+      d.splice_front(dSrc, 9);
+      // verify
+      assertUnit(Spy::numCopyMove() == 6);      // move 100, 9, 8, 3, 2, 1
+      assertUnit(Spy::numDestructor() == 6);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      //    [0]     [1, 2, 3][4, 5, 6, 7][8, 9, 100]
+      assertUnit(d.size() == 10);
+      assertUnit(d.data[d.ibFromID(3)] == pBlock1);
+      for (int i = 0; i < 9; i++)
+         assertUnit(d[i] == Spy(i + 1));
+      assertUnit(d.back() == Spy(100));
+      assertUnit(dSrc.size() == 1);
+      assertUnit(dSrc.front() == Spy(0));
+   }  // teardown
+
+   // append a deque whose front lines up with our back
+   void test_appenddeque_seam()
+   {  // setup
+      //    [100, 101]     [  ,   , 2, 3][4, 5, 6, 7][8, 9, 10, 11]
+      custom::deque<Spy> d;
+      d.numCells = 4;
+      d.push_back(Spy(100));
+      d.push_back(Spy(101));
+      custom::deque<Spy> dSrc;
+      dSrc.numCells = 4;
+      for (int i = 0; i < 12; i++)
+         dSrc.push_back(Spy(i));
+      dSrc.pop_front();
+      dSrc.pop_front();
+      Spy* pBlock1 = dSrc.data[1];
+      Spy* pBlock2 = dSrc.data[2];
+      Spy::reset();
+      // exercise
+      d.append_deque(std::move(dSrc));
+      // verify
+      assertUnit(Spy::numCopyMove() == 2);      // move 2, 3 across the seam
+      assertUnit(Spy::numDestructor() == 2);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      //    [100, 101, 2, 3][4, 5, 6, 7][8, 9, 10, 11]
+      assertUnit(d.size() == 12);
+      assertUnit(d[0] == Spy(100));
+      assertUnit(d[1] == Spy(101));
+      for (int i = 2; i < 12; i++)
+         assertUnit(d[i] == Spy(i));
+      assertUnit(d.data[d.ibFromID(4)] == pBlock1);
+      assertUnit(d.data[d.ibFromID(8)] == pBlock2);
+      assertUnit(dSrc.empty());
+   }  // teardown
+
+   // an empty deque takes over the other's map
+   void test_appenddeque_empty()
+   {  // setup
+      custom::deque<Spy> dSrc;
+      setupStandardFixture(dSrc);
+      Spy** data = dSrc.data;
+      custom::deque<Spy> d;
+      d.numCells = 3;
+      Spy::reset();
+      // exercise
+      d.append_deque(std::move(dSrc));
+      // verify
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(d.data == data);
+      assertStandardFixture(d);
+      assertUnit(dSrc.empty());
+      assertUnit(dSrc.data == nullptr);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // split in the middle of a block: only that block's tail share moves
+   void test_splitat_adoptBlocks()
+   {  // setup
+      //    [  , 1, 2, 3][4, 5, 6, 7][8, 9, 10, 11]
+      custom::deque<Spy> d;
+      d.numCells = 4;
+      for (int i = 0; i < 12; i++)
+         d.push_back(Spy(i));
+      d.pop_front();
+      Spy* pBlock2 = d.data[2];
+      Spy::reset();
+      // exercise
+      custom::deque<Spy> dTail = d.split_at(5);
+      // verify
+      assertUnit(Spy::numCopyMove() == 2);      // move 6, 7
+      assertUnit(Spy::numDestructor() == 2);    // destroy moved-from 6, 7
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      //    [  , 1, 2, 3][4, 5,  ,  ]
+      //    [  ,  , 6, 7][8, 9, 10, 11]
+      assertUnit(d.size() == 5);
+      for (int i = 0; i < 5; i++)
+         assertUnit(d[i] == Spy(i + 1));
+      assertUnit(d.data[2] == nullptr);
+      assertUnit(dTail.size() == 6);
+      for (int i = 0; i < 6; i++)
+         assertUnit(dTail[i] == Spy(i + 6));
+      assertUnit(dTail.data[dTail.ibFromID(2)] == pBlock2);
+      assertUnit(dTail.icFromID(0) == 2);
+   }  // teardown
+
+   // split a deque whose back has wrapped into the front's block
+   void test_splitat_wrappedShared()
+   {  // setup
+      //     iaFront
+      //   +----+----+----+  +----+----+----+
+      //   | 14 | 15 | 10 |  | 11 | 12 | 13 |
+      //   +----+----+----+  +----+----+----+
+      custom::deque<Spy> d;
+      d.numCells = 3;
+      d.numBlocks = 2;
+      d.numElements = 6;
+      d.iaFront = 2;
+      d.data = new Spy * [2];
+      d.data[0] = d.alloc.allocate(d.numCells);
+      d.data[1] = d.alloc.allocate(d.numCells);
+      construct(d.alloc, &d.data[0][2], Spy(10));
+      construct(d.alloc, &d.data[1][0], Spy(11));
+      construct(d.alloc, &d.data[1][1], Spy(12));
+      construct(d.alloc, &d.data[1][2], Spy(13));
+      construct(d.alloc, &d.data[0][0], Spy(14));
+      construct(d.alloc, &d.data[0][1], Spy(15));
+      Spy::reset();
+      // exercise
+      custom::deque<Spy> dTail = d.split_at(2);
       // verify
-      assertUnit(Spy::numDelete() == 1);        // delete 79
-      assertUnit(Spy::numDestructor() == 1);    // destroy 79
+      assertUnit(Spy::numCopyMove() == 4);      // both blocks are shared
+      assertUnit(Spy::numDestructor() == 4);
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
-      assertUnit(Spy::numAssign() == 0);
-      assertUnit(Spy::numDefault() == 0);
-      assertUnit(Spy::numNondefault() == 0);
-      assertUnit(Spy::numCopyMove() == 0);
-      assertUnit(Spy::numAssignMove() == 0);
-      //   iaFront
-      //                            iaFront
-      //                       +----+----+----+
-      //                       |    | 59 | 67 |
-      //                       +----+----+----+
-      //                                   |
-      //   +----+----+----+----+----+----+----+
-      //   | // | // | // | // | // | // |    |
-      //   +----+----+----+----+----+----+----+
-      assertUnit(d.numElements == 2);
-      assertUnit(d.iaFront == 19);
-      assertUnit(d.numBlocks == 7);
-      assertUnit(d.numCells == 3);
-      assertUnit(d.data != nullptr);
-      if (d.data)
-      {
-         assertUnit(d.data[0] == nullptr);
-         assertUnit(d.data[1] == nullptr);
-         assertUnit(d.data[2] == nullptr);
-         assertUnit(d.data[3] == nullptr);
-         assertUnit(d.data[4] == nullptr);
-         assertUnit(d.data[5] == nullptr);
-         assertUnit(d.data[6] == pBlock);
-         if (d.data[6])
-         {
-            assertUnit(d.data[6][1] == Spy(59));
-            assertUnit(d.data[6][2] == Spy(67));
-         }
-      }
-      // teardown
-      teardownStandardFixture(d);
-   }
-
+      assertUnit(Spy::numDelete() == 0);
+      //   +----+----+----+  +----+----+----+
+      //   |    |    | 10 |  | 11 |    |    |
+      //   +----+----+----+  +----+----+----+
+      //   +----+----+----+  +----+----+----+
+      //   |    | 12 | 13 |  | 14 | 15 |    |
+      //   +----+----+----+  +----+----+----+
+      assertUnit(d.size() == 2);
+      assertUnit(d.front() == Spy(10));
+      assertUnit(d.back() == Spy(11));
+      assertUnit(dTail.size() == 4);
+      for (int i = 0; i < 4; i++)
+         assertUnit(dTail[i] == Spy(i + 12));
+      assertUnit(dTail.iaFront == 1);
+   }  // teardown
 
    /***************************************
     * BACK
@@ -2575,10 +3773,10 @@ public:
       d.data[1] = nullptr;
       d.data[2] = nullptr;
       d.data[3] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[3][1], Spy(31));
-      d.alloc.construct(&d.data[3][2], Spy(49));
-      d.alloc.construct(&d.data[0][0], Spy(55));
-      d.alloc.construct(&d.data[0][1], Spy(67));
+      construct(d.alloc, &d.data[3][1], Spy(31));
+      construct(d.alloc, &d.data[3][2], Spy(49));
+      construct(d.alloc, &d.data[0][0], Spy(55));
+      construct(d.alloc, &d.data[0][1], Spy(67));
       Spy s(99);
       Spy::reset();
       // exercise
@@ -2700,10 +3898,10 @@ public:
       d.data[1] = nullptr;
       d.data[2] = nullptr;
       d.data[3] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[3][1], Spy(31));
-      d.alloc.construct(&d.data[3][2], Spy(49));
-      d.alloc.construct(&d.data[0][0], Spy(55));
-      d.alloc.construct(&d.data[0][1], Spy(67));
+      construct(d.alloc, &d.data[3][1], Spy(31));
+      construct(d.alloc, &d.data[3][2], Spy(49));
+      construct(d.alloc, &d.data[0][0], Spy(55));
+      construct(d.alloc, &d.data[0][1], Spy(67));
       Spy s(99);
       Spy::reset();
       // exercise
@@ -2915,10 +4113,10 @@ public:
       d.data[1] = nullptr;
       d.data[2] = nullptr;
       d.data[3] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[3][1], Spy(31));
-      d.alloc.construct(&d.data[3][2], Spy(49));
-      d.alloc.construct(&d.data[0][0], Spy(55));
-      d.alloc.construct(&d.data[0][1], Spy(67));
+      construct(d.alloc, &d.data[3][1], Spy(31));
+      construct(d.alloc, &d.data[3][2], Spy(49));
+      construct(d.alloc, &d.data[0][0], Spy(55));
+      construct(d.alloc, &d.data[0][1], Spy(67));
       Spy s0(99);
       Spy s1(99);
       Spy s2(99);
@@ -3059,10 +4257,10 @@ public:
       d.data[1] = nullptr;
       d.data[2] = nullptr;
       d.data[3] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[3][1], Spy(31));
-      d.alloc.construct(&d.data[3][2], Spy(49));
-      d.alloc.construct(&d.data[0][0], Spy(55));
-      d.alloc.construct(&d.data[0][1], Spy(67));
+      construct(d.alloc, &d.data[3][1], Spy(31));
+      construct(d.alloc, &d.data[3][2], Spy(49));
+      construct(d.alloc, &d.data[0][0], Spy(55));
+      construct(d.alloc, &d.data[0][1], Spy(67));
       Spy s0(10);
       Spy s1(11);
       Spy s2(12);
@@ -3119,6 +4317,85 @@ public:
    }
 
 
+   /***************************************
+    * GATHER
+    ***************************************/
+
+   // gather from a deque that wraps around the end of the array
+   void test_gather_wrapped()
+   {  // setup
+      //                                iaFront
+      //   +----+----+----+    +----+----+----+
+      //   | 67 | 79 |    |    |    |    | 59 |
+      //   +----+----+----+    +----+----+----+
+      //     |                             |
+      //   +----+----+----+----+----+----+----+
+      //   |    | // | // | // | // | // |    |
+      //   +----+----+----+----+----+----+----+
+      custom::deque<Spy> d;
+      d.numCells = 3;
+      d.numElements = 3;
+      d.numBlocks = 7;
+      d.data = new Spy * [7];
+      d.data[0] = d.alloc.allocate(d.numCells);
+      d.data[1] = nullptr;
+      d.data[2] = nullptr;
+      d.data[3] = nullptr;
+      d.data[4] = nullptr;
+      d.data[5] = nullptr;
+      d.data[6] = d.alloc.allocate(d.numCells);
+      construct(d.alloc, &d.data[6][2], Spy(59));
+      construct(d.alloc, &d.data[0][0], Spy(67));
+      construct(d.alloc, &d.data[0][1], Spy(79));
+      d.iaFront = 20;
+      int ids[] = { 2, 0, 1, 2 };
+      Spy out[4];
+      Spy::reset();
+      // exercise
+      d.gather(ids, 4, out);
+      // verify
+      assertUnit(Spy::numAssign() == 4);     // assign [79, 59, 67, 79]
+      assertUnit(Spy::numAlloc() == 4);      // allocate [79, 59, 67, 79]
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(out[0] == Spy(79));
+      assertUnit(out[1] == Spy(59));
+      assertUnit(out[2] == Spy(67));
+      assertUnit(out[3] == Spy(79));
+      assertUnit(d.numElements == 3);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // gather in block order with power-of-two blocks
+   void test_gather_sortedPowerOfTwo()
+   {  // setup
+      //    [9, 8, 7, 6, 5, 4, 3, 2, 1, 0] in blocks of four
+      custom::deque<Spy> d;
+      d.numCells = 4;
+      for (int i = 0; i < 10; i++)
+         d.push_front(Spy(i));
+      int ids[] = { 9, 0, 5, 3, 5 };
+      Spy out[5];
+      Spy::reset();
+      // exercise
+      d.gather(ids, 5, out, true /*sortByBlock*/);
+      // verify
+      assertUnit(Spy::numAssign() == 5);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(out[0] == Spy(0));
+      assertUnit(out[1] == Spy(9));
+      assertUnit(out[2] == Spy(4));
+      assertUnit(out[3] == Spy(6));
+      assertUnit(out[4] == Spy(4));
+      assertUnit(d.size() == 10);
+   }  // teardown
+
    /***************************************
     * ITERATOR
     ***************************************/
@@ -3281,6 +4558,39 @@ public:
       teardownStandardFixture(d);
    }
 
+   // walk the whole deque, crossing the blocks and the map's wrap
+   void test_iterator_increment_acrossBlocks()
+   {  // setup
+      //    +----+----+----+  +----+----+----+
+      //    |    | 31 | 49 |  | 55 | 67 |    |
+      //    +----+----+----+  +----+----+----+
+      //               \        /
+      //          +----+----+----+----+
+      //          | // |    |    | // |
+      //          +----+----+----+----+
+      custom::deque<Spy> d;
+      setupStandardFixture(d);
+      custom::deque<Spy>::iterator it = d.begin();
+      Spy::reset();
+      // exercise
+      int values[4];
+      int num = 0;
+      for (; it != d.end(); ++it)
+         values[num++] = (*it).get();
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(num == 4);
+      assertUnit(values[0] == 31);
+      assertUnit(values[1] == 49);
+      assertUnit(values[2] == 55);
+      assertUnit(values[3] == 67);
+      assertUnit(it.id == 4);
+      assertStandardFixture(d);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
    // the the iterator's dereference operator to access an item from the list
    void test_iterator_dereference_read()
    {  // setup
@@ -3522,6 +4832,513 @@ public:
    }
 
 
+   /***************************************
+    * POLICY
+    ***************************************/
+
+   // throughput fills a page per block
+   void test_policy_blockCells()
+   {  // setup
+      custom::deque<int, std::allocator<int>, custom::throughput> d;
+      // exercise
+      for (int i = 0; i < 1024; i++)
+         d.push_back(i);
+      // verify
+      assertUnit(d.numCells == 1024);
+      assertUnit(d.numBlocks == 1);
+      assertUnit(d.back() == 1023);
+      assertUnit((custom::low_latency::block_cells<int>() == 128));
+      assertUnit((custom::low_latency::block_cells<char[64]>() == 16));
+   }  // teardown
+
+   // low_memory grows the map by half, not by double
+   struct GrowByHalf : custom::low_memory
+   {
+      static constexpr bool fit_size_class() { return false; }
+   };
+   void test_policy_grow()
+   {  // setup
+      custom::deque<int, std::allocator<int>, GrowByHalf> d;
+      d.numCells = 1;
+      std::vector<size_t> sizes;
+      // exercise
+      for (int i = 0; i < 20; i++)
+      {
+         d.push_back(i);
+         if (sizes.empty() || sizes.back() != d.numBlocks)
+            sizes.push_back(d.numBlocks);
+      }
+      // verify
+      assertUnit(sizes == std::vector<size_t>({ 1, 2, 4, 7, 11, 17, 26 }));
+      for (int i = 0; i < 20; i++)
+         assertUnit(d[i] == i);
+   }  // teardown
+
+   // low_latency keeps emptied blocks, so a steady queue stops allocating
+   // once it has a block in every slot of its map
+   void test_policy_cacheSpare()
+   {  // setup
+      custom::deque<int, std::allocator<int>, custom::with_stats<custom::low_latency>> d;
+      for (int i = 0; i < 1000; i++)
+         d.push_back(i);
+      // exercise
+      for (int i = 1000; i < 100000; i++)
+      {
+         d.pop_front();
+         d.push_back(i);
+      }
+      // verify
+      assertUnit(d.statistics().numBlockAllocations <= d.numBlocks);
+      assertUnit(d.statistics().numBlockFrees == 0);
+      assertUnit(d.size() == 1000);
+      assertUnit(d.front() == 99000);
+      assertUnit(d.back() == 99999);
+      // exercise
+      d.clear();
+      // verify
+      assertUnit(d.statistics().numBlockFrees == d.statistics().numBlockAllocations);
+   }  // teardown
+
+   // shrinking by assign or remove_if keeps the blocks too
+   void test_policy_cacheSpareShrink()
+   {  // setup
+      custom::deque<int, std::allocator<int>, custom::with_stats<custom::low_latency>> d;
+      int round = 0;
+      auto cycle = [&]()
+      {
+         d.assign(5000, round);
+         d.remove_if([](int i) { return i % 2 == 0; });
+         d.assign(3000, 1);
+         d.assign(10, 1);
+         d.remove_if([](int) { return true; });
+         round++;
+      };
+      cycle();
+      size_t numAllocations = d.statistics().numBlockAllocations;
+      // exercise
+      for (int i = 0; i < 4; i++)
+         cycle();
+      // verify
+      assertUnit(d.empty());
+      assertUnit(d.statistics().numBlockAllocations == numAllocations);
+      assertUnit(d.statistics().numBlockFrees == 0);
+      // exercise
+      d.clear();
+      // verify
+      assertUnit(d.statistics().numBlockFrees == numAllocations);
+   }  // teardown
+
+   // low_latency blocks start on a cache line
+   void test_policy_alignment()
+   {
+#ifdef __cpp_aligned_new
+      // setup
+      custom::deque<char, std::allocator<char>, custom::low_latency> d;
+      // exercise
+      for (int i = 0; i < 5000; i++)
+         d.push_front(static_cast<char>(i));
+      // verify
+      assertUnit(d.numCells == 512);
+      for (size_t ib = 0; ib < d.numBlocks; ib++)
+         assertUnit(d.data[ib] == nullptr ||
+                    reinterpret_cast<uintptr_t>(d.data[ib]) % 64 == 0);
+      assertUnit(d.front() == static_cast<char>(4999));
+#endif
+   }  // teardown
+
+   // the counters follow blocks in and out and the map growing
+   void test_policy_stats()
+   {  // setup
+      custom::deque<int, std::allocator<int>, custom::with_stats<>> d;
+      // exercise
+      for (int i = 0; i < 64; i++)
+         d.push_back(i);
+      for (int i = 0; i < 20; i++)
+         d.pop_front();
+      // verify
+      //   blocks: 4 taken, 1 given back; map: 1 -> 2 -> 4
+      assertUnit(d.statistics().numBlockAllocations == 4);
+      assertUnit(d.statistics().numBlockFrees == 1);
+      assertUnit(d.statistics().numMapGrowths == 2);
+      assertUnit(sizeof(custom::deque<int>) <= sizeof(d));
+   }  // teardown
+
+   // the counts follow the blocks when a deque moves or is adopted
+   void test_policy_statsMove()
+   {  // setup
+      typedef custom::deque<int, std::allocator<int>, custom::with_stats<>> Deque;
+      Deque d;
+      for (int i = 0; i < 64; i++)
+         d.push_back(i);
+      // exercise
+      Deque dMove(std::move(d));
+      // verify
+      assertUnit(dMove.statistics().numBlockAllocations == 4);
+      assertUnit(d.statistics().numBlockAllocations == 0);
+      // exercise
+      Deque dAppend;
+      dAppend.append_deque(std::move(dMove));
+      dAppend.clear();
+      // verify
+      assertUnit(dAppend.statistics().numBlockAllocations == 4);
+      assertUnit(dAppend.statistics().numBlockFrees == 4);
+      assertUnit(dMove.statistics().numBlockAllocations == 0);
+      assertUnit(dMove.statistics().numBlockFrees == 0);
+   }  // teardown
+
+   // low_memory blocks fill what malloc would round them up to
+   void test_policy_fitSizeClass()
+   {
+#if defined(__GLIBC__)
+      assertUnit(custom::malloc_size_class(1) == 24);
+      assertUnit(custom::malloc_size_class(64) == 72);
+      assertUnit(custom::malloc_size_class(72) == 72);
+#else
+      assertUnit(custom::malloc_size_class(64) == 64);
+      assertUnit(custom::malloc_size_class(129) == 160);
+#endif
+      // setup
+      custom::deque<int, std::allocator<int>, custom::low_memory> d;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         d.push_back(i);
+      // verify
+      assertUnit(d.numCells == custom::malloc_size_class(16 * sizeof(int)) / sizeof(int));
+      assertUnit(d.numBlocks * sizeof(int *) == custom::malloc_size_class(d.numBlocks * sizeof(int *)));
+      for (int i = 0; i < 100; i++)
+         assertUnit(d[i] == i);
+   }
+
+   // gives four more cells than asked, and says so
+   template <typename U>
+   struct GenerousAllocator
+   {
+      typedef U value_type;
+      struct result
+      {
+         U * ptr;
+         size_t count;
+      };
+      GenerousAllocator() {}
+      template <typename V>
+      GenerousAllocator(const GenerousAllocator<V> &) {}
+      U * allocate(size_t num)          { return std::allocator<U>().allocate(num); }
+      result allocate_at_least(size_t num) { return { allocate(num + 4), num + 4 }; }
+      void deallocate(U * p, size_t num) { std::allocator<U>().deallocate(p, num); }
+      bool operator == (const GenerousAllocator &) const { return true; }
+      bool operator != (const GenerousAllocator &) const { return false; }
+   };
+
+   // the first block sets how big every block is
+   void test_allocateAtLeast_firstBlock()
+   {  // setup
+      custom::deque<Spy, GenerousAllocator<Spy>> d;
+      Spy::reset();
+      // exercise
+      for (int i = 0; i < 30; i++)
+         d.push_front(Spy(i));
+      for (int i = 0; i < 30; i++)
+         d.push_back(Spy(i));
+      // verify
+      assertUnit(d.numCells == 20);
+      assertUnit(d.numBlocks == 4);
+      assertUnit(d.size() == 60);
+      assertUnit(d.front() == Spy(29));
+      assertUnit(d.back() == Spy(29));
+      // exercise
+      d.clear();
+      // verify
+      assertUnit(Spy::numAlloc() == Spy::numDelete());
+   }  // teardown
+
+   /***************************************
+    * CONSTEXPR
+    ***************************************/
+
+   // grow both ends across blocks, shift the middle, and shrink,
+   // all inside what C++20 can evaluate as a constant expression
+   static DEQUE_CONSTEXPR bool buildAtCompileTime()
+   {
+      custom::deque<int> d;
+      for (int i = 1; i <= 40; i++)
+      {
+         d.push_back(i);
+         d.push_front(-i);
+      }
+      d.pop_front();
+      d.pop_back();
+      d.insert(custom::deque<int>::iterator(39, &d), 0);
+      bool inserted = (d[39] == 0 && d[40] == 1);
+      d.erase(custom::deque<int>::iterator(39, &d));
+
+      int sum = 0;
+      for (auto it = d.begin(); it != d.end(); ++it)
+         sum += *it;
+
+      custom::deque<int> dCopy(d);
+      return inserted && sum == 0 && d.size() == 78 && d.numBlocks == 8 &&
+             d.front() == -39 && d.back() == 39 && d[39] == 1 &&
+             dCopy.size() == 78 && dCopy[77] == 39;
+   }
+
+   void test_constexpr_build()
+   {
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+      static_assert(buildAtCompileTime(), "deque must be usable at compile time");
+#endif
+      assertUnit(buildAtCompileTime());
+   }
+
+   /***************************************
+    * COMPLEXITY
+    * Each operation is run at sizes 2^10 through 2^20. The Spy
+    * and allocator counters must stay within the operation's
+    * complexity class so an asymptotic regression fails even
+    * when the contents are still correct.
+    ***************************************/
+
+   // push_back: one copy per element, amortized O(1) map growth
+   void test_complexity_pushBack()
+   {
+      for (int num = COMPLEXITY_MIN; num <= COMPLEXITY_MAX; num *= 2)
+      {  // setup
+         CountingDeque d;
+         Spy s(99);
+         int numMapCopies = 0;
+         Spy::reset();
+         // exercise
+         for (int i = 0; i < num; i++)
+         {
+            Spy ** dataOld = d.data;
+            size_t numBlocksOld = d.numBlocks;
+            d.push_back(s);
+            if (d.data != dataOld)
+               numMapCopies += (int)numBlocksOld;
+         }
+         // verify
+         assertUnit(Spy::numCopy() == num);
+         assertUnit(Spy::numAlloc() == num);
+         assertUnit(Spy::numCopyMove() == 0);
+         assertUnit(Spy::numAssign() == 0);
+         assertUnit(Spy::numAssignMove() == 0);
+         assertUnit(Spy::numDestructor() == 0);
+         assertUnit(d.alloc.numAllocate <= numBlocksFor(num, d.numCells));
+         assertUnit(numMapCopies <= 2 * (int)d.numBlocks);
+         assertUnit(d.size() == (size_t)num);
+      }  // teardown
+   }
+
+   // push_front: one copy per element, amortized O(1) map growth
+   void test_complexity_pushFront()
+   {
+      for (int num = COMPLEXITY_MIN; num <= COMPLEXITY_MAX; num *= 2)
+      {  // setup
+         CountingDeque d;
+         Spy s(99);
+         int numMapCopies = 0;
+         Spy::reset();
+         // exercise
+         for (int i = 0; i < num; i++)
+         {
+            Spy ** dataOld = d.data;
+            size_t numBlocksOld = d.numBlocks;
+            d.push_front(s);
+            if (d.data != dataOld)
+               numMapCopies += (int)numBlocksOld;
+         }
+         // verify
+         assertUnit(Spy::numCopy() == num);
+         assertUnit(Spy::numAlloc() == num);
+         assertUnit(Spy::numCopyMove() == 0);
+         assertUnit(Spy::numAssign() == 0);
+         assertUnit(Spy::numAssignMove() == 0);
+         assertUnit(Spy::numDestructor() == 0);
+         assertUnit(d.alloc.numAllocate <= numBlocksFor(num, d.numCells));
+         assertUnit(numMapCopies <= 2 * (int)d.numBlocks);
+         assertUnit(d.size() == (size_t)num);
+      }  // teardown
+   }
+
+   // pop_back and pop_front: one destroy per element, every block freed
+   void test_complexity_pop()
+   {
+      for (int num = COMPLEXITY_MIN; num <= COMPLEXITY_MAX; num *= 2)
+      {  // setup
+         CountingDeque d;
+         fillComplexity(d, num);
+         Spy::reset();
+         // exercise
+         for (int i = 0; i < num; i++)
+            if (i % 2)
+               d.pop_back();
+            else
+               d.pop_front();
+         // verify
+         assertUnit(Spy::numDestructor() == num);
+         assertUnit(Spy::numDelete() == num);
+         assertUnit(Spy::numCopy() == 0);
+         assertUnit(Spy::numCopyMove() == 0);
+         assertUnit(Spy::numAssign() == 0);
+         assertUnit(Spy::numAssignMove() == 0);
+         assertUnit(d.alloc.numDeallocate == d.alloc.numAllocate);
+         assertUnit(d.empty());
+      }  // teardown
+   }
+
+   // copy constructor: one copy per element, no moves or assignments
+   void test_complexity_copy()
+   {
+      for (int num = COMPLEXITY_MIN; num <= COMPLEXITY_MAX; num *= 2)
+      {  // setup
+         CountingDeque dSrc;
+         fillComplexity(dSrc, num);
+         Spy::reset();
+         // exercise
+         CountingDeque dDes(dSrc);
+         // verify
+         assertUnit(Spy::numCopy() == num);
+         assertUnit(Spy::numAlloc() == num);
+         assertUnit(Spy::numCopyMove() == 0);
+         assertUnit(Spy::numAssign() == 0);
+         assertUnit(Spy::numAssignMove() == 0);
+         assertUnit(Spy::numDestructor() == 0);
+         assertUnit(dDes.size() == (size_t)num);
+      }  // teardown
+   }
+
+   // subscript and iterator: reading touches no Spy at all
+   void test_complexity_access()
+   {
+      for (int num = COMPLEXITY_MIN; num <= COMPLEXITY_MAX; num *= 2)
+      {  // setup
+         CountingDeque d;
+         fillComplexity(d, num);
+         int numAllocate = d.alloc.numAllocate;
+         Spy::reset();
+         // exercise
+         int numNull = 0;
+         for (int id = 0; id < num; id++)
+            numNull += d[id].empty() ? 1 : 0;
+         for (auto it = d.begin(); it != d.end(); ++it)
+            numNull += (*it).empty() ? 1 : 0;
+         // verify
+         assertUnit(numNull == 0);
+         assertUnit(Spy::numCopy() == 0);
+         assertUnit(Spy::numCopyMove() == 0);
+         assertUnit(Spy::numAssign() == 0);
+         assertUnit(Spy::numAssignMove() == 0);
+         assertUnit(Spy::numDestructor() == 0);
+         assertUnit(d.alloc.numAllocate == numAllocate);
+      }  // teardown
+   }
+
+   // insert and erase in the middle: each shifts at most half the deque
+   void test_complexity_insertErase()
+   {
+      for (int num = COMPLEXITY_MIN; num <= COMPLEXITY_MAX; num *= 2)
+      {  // setup
+         CountingDeque d;
+         fillComplexity(d, num);
+         Spy s(99);
+         Spy::reset();
+         // exercise
+         d.insert(CountingDeque::iterator(num / 2, &d), s);
+         d.erase(CountingDeque::iterator(num / 2, &d));
+         // verify
+         assertUnit(Spy::numCopy() == 1);
+         assertUnit(Spy::numCopyMove() <= 4);
+         assertUnit(Spy::numAssignMove() <= num + 2);
+         assertUnit(Spy::numAssign() == 0);
+         assertUnit(d.size() == (size_t)num);
+      }  // teardown
+   }
+
+   // near either end only the short side shifts, whatever the size
+   void test_complexity_insertEraseEnds()
+   {
+      for (int num = COMPLEXITY_MIN; num <= COMPLEXITY_MAX; num *= 2)
+         for (int id : { 1, num - 2 })
+         {  // setup
+            CountingDeque d;
+            fillComplexity(d, num);
+            Spy s(99);
+            Spy::reset();
+            // exercise
+            d.insert(CountingDeque::iterator(id, &d), s);
+            // verify
+            assertUnit(Spy::numCopy() == 1);
+            assertUnit(Spy::numCopyMove() + Spy::numAssignMove() <= 4);
+            assertUnit(d[id] == s);
+            Spy::reset();
+            // exercise
+            d.erase(CountingDeque::iterator(id, &d));
+            // verify
+            assertUnit(Spy::numCopyMove() + Spy::numAssignMove() <= 4);
+            assertUnit(Spy::numAssign() == 0);
+            assertUnit(d.size() == (size_t)num);
+         }  // teardown
+   }
+
+   // clear: one destroy per element, every block freed
+   void test_complexity_clear()
+   {
+      for (int num = COMPLEXITY_MIN; num <= COMPLEXITY_MAX; num *= 2)
+      {  // setup
+         CountingDeque d;
+         fillComplexity(d, num);
+         Spy::reset();
+         // exercise
+         d.clear();
+         // verify
+         assertUnit(Spy::numDestructor() == num);
+         assertUnit(Spy::numDelete() == num);
+         assertUnit(Spy::numCopy() == 0);
+         assertUnit(Spy::numCopyMove() == 0);
+         assertUnit(d.alloc.numDeallocate == d.alloc.numAllocate);
+         assertUnit(d.empty());
+      }  // teardown
+   }
+
+
+   /*************************************************************
+    * COMPLEXITY FIXTURE
+    * Half the elements pushed on the front and half on the back
+    * so both growth directions are exercised
+    *************************************************************/
+   static const int COMPLEXITY_MIN = 1 << 10;
+   static const int COMPLEXITY_MAX = 1 << 20;
+   typedef custom::deque<Spy, CountingAllocator<Spy>> CountingDeque;
+
+   void fillComplexity(CountingDeque& d, int num)
+   {
+      for (int i = 0; i < num; i++)
+         if (i % 2)
+            d.push_back(Spy(i));
+         else
+            d.push_front(Spy(i));
+   }
+
+   // the most blocks a contiguous run of num elements can touch
+   static int numBlocksFor(int num, size_t numCells)
+   {
+      return num / (int)numCells + 2;
+   }
+
+   /*************************************************************
+    * CONSTRUCT and DESTROY
+    * std::allocator::construct and destroy were removed in C++20
+    *************************************************************/
+   template <typename A, typename T, typename ... Args>
+   static void construct(A& alloc, T* p, Args&& ... args)
+   {
+      std::allocator_traits<A>::construct(alloc, p, std::forward<Args>(args)...);
+   }
+   template <typename A, typename T>
+   static void destroy(A& alloc, T* p)
+   {
+      std::allocator_traits<A>::destroy(alloc, p);
+   }
+
    /*************************************************************
     * SETUP STANDARD FIXTURE
     *    [31, 49, 55, 67]
@@ -3552,10 +5369,10 @@ public:
       d.data[2] = d.alloc.allocate(d.numCells);
       d.data[3] = nullptr;
 
-      d.alloc.construct(&d.data[1][1], Spy(31));
-      d.alloc.construct(&d.data[1][2], Spy(49));
-      d.alloc.construct(&d.data[2][0], Spy(55));
-      d.alloc.construct(&d.data[2][1], Spy(67));
+      construct(d.alloc, &d.data[1][1], Spy(31));
+      construct(d.alloc, &d.data[1][2], Spy(49));
+      construct(d.alloc, &d.data[2][0], Spy(55));
+      construct(d.alloc, &d.data[2][1], Spy(67));
    }
 
    /*************************************************************
@@ -3630,19 +5447,12 @@ public:
             int ib = d.ibFromID((int)id);
             int ic = d.icFromID((int)id);
             if (ib != -1 && ic != -1)
-               d.alloc.destroy(&d.data[ib][ic]);
+               destroy(d.alloc, &d.data[ib][ic]);
          }
 
-         if (d.numBlocks > 0 && d.data[0])
-            d.alloc.deallocate(d.data[0], d.numCells);
-         if (d.numBlocks > 1 && d.data[1])
-            d.alloc.deallocate(d.data[1], d.numCells);
-         if (d.numBlocks > 2 && d.data[2])
-            d.alloc.deallocate(d.data[2], d.numCells);
-         if (d.numBlocks > 3 && d.data[3])
-            d.alloc.deallocate(d.data[3], d.numCells);
-         if (d.numBlocks > 4 && d.data[4])
-            d.alloc.deallocate(d.data[4], d.numCells);
+         for (size_t ib = 0; ib < d.numBlocks; ib++)
+            if (d.data[ib])
+               d.alloc.deallocate(d.data[ib], d.numCells);
 
          delete [] d.data;
       }
@@ -0,0 +1,270 @@
+/***********************************************************************
+ * Header:
+ *    TEST GEOMETRIC
+ * Summary:
+ *    Unit tests for the deque with doubling blocks
+ * Author
+ *    Marco Varela & Andre Regino
+ ************************************************************************/
+
+#pragma once
+#ifdef DEBUG
+
+#include "geometric.h"  // class under test
+#include "spy.h"        // for the Spy class
+#include "unitTest.h"   // unit test baseclass
+#include <vector>       // for std::vector
+
+/***********************************************
+ * TEST GEOMETRIC
+ * Unit tests for the deque with doubling blocks
+ ***********************************************/
+class TestGeometric : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Utilities
+      test_floorLog2();
+      test_blockOf();
+
+      // Insert
+      test_pushBack_doublingBlocks();
+      test_pushFront_inOrder();
+      test_push_acrossOrigin();
+
+      // Remove
+      test_popBack_keepsOneSpare();
+      test_popFront_emptyStartsOver();
+      test_clear_standard();
+
+      // Copy
+      test_copy_standard();
+      test_move_standard();
+
+      report("Geometric");
+   }
+
+   /***************************************
+    * UTILITIES
+    ***************************************/
+
+   void test_floorLog2()
+   {
+      assertUnit(custom::floorLog2(1) == 0);
+      assertUnit(custom::floorLog2(2) == 1);
+      assertUnit(custom::floorLog2(3) == 1);
+      assertUnit(custom::floorLog2(1024) == 10);
+      assertUnit(custom::floorLog2(static_cast<size_t>(-1)) == static_cast<int>(sizeof(size_t) * 8 - 1));
+   }
+
+   // blocks of 16, 32, 64 ... cells
+   void test_blockOf()
+   {
+      typedef custom::geometric_deque<int> Deque;
+      assertUnit(Deque::blockOf(0) == 0);
+      assertUnit(Deque::blockOf(15) == 0);
+      assertUnit(Deque::blockOf(16) == 1);
+      assertUnit(Deque::blockOf(47) == 1);
+      assertUnit(Deque::blockOf(48) == 2);
+      assertUnit(Deque::blockOf(111) == 2);
+      assertUnit(Deque::blockOf(112) == 3);
+      assertUnit(Deque::blockStart(3) == 112);
+      assertUnit(Deque::blockSize(3) == 128);
+   }
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // 112 elements fill the first three blocks exactly
+   void test_pushBack_doublingBlocks()
+   {  // setup
+      custom::geometric_deque<int> d;
+      // exercise
+      for (int i = 0; i < 112; i++)
+         d.push_back(i);
+      // verify
+      assertUnit(d.size() == 112);
+      assertUnit(d.blocks[0][0] != nullptr);
+      assertUnit(d.blocks[0][1] != nullptr);
+      assertUnit(d.blocks[0][2] != nullptr);
+      assertUnit(d.blocks[0][3] == nullptr);
+      assertUnit(d.blocks[1][0] == nullptr);
+      assertUnit(&d[16] == d.blocks[0][1]);
+      assertUnit(&d[111] == d.blocks[0][2] + 63);
+      for (int i = 0; i < 112; i++)
+         assertUnit(d[i] == i);
+      assertUnit(d.front() == 0);
+      assertUnit(d.back() == 111);
+   }  // teardown
+
+   // the front side's blocks are reversed, so they read in order
+   void test_pushFront_inOrder()
+   {  // setup
+      custom::geometric_deque<int> d;
+      // exercise
+      for (int i = 0; i < 48; i++)
+         d.push_front(i);
+      // verify
+      //   front block 1: [47 ... 16]   front block 0: [15 ... 0]
+      assertUnit(d.posFront == -48);
+      assertUnit(&d[0] == d.blocks[1][1]);
+      assertUnit(&d[31] == d.blocks[1][1] + 31);
+      assertUnit(&d[32] == d.blocks[1][0]);
+      assertUnit(&d[47] == d.blocks[1][0] + 15);
+      for (int i = 0; i < 48; i++)
+         assertUnit(d[i] == 47 - i);
+   }  // teardown
+
+   // segments run front to back across the origin
+   void test_push_acrossOrigin()
+   {  // setup
+      custom::geometric_deque<int> d;
+      for (int i = 1; i <= 20; i++)
+         d.push_front(-i);
+      for (int i = 0; i < 20; i++)
+         d.push_back(i);
+      // exercise
+      std::vector<size_t> runs;
+      std::vector<int> values;
+      const custom::geometric_deque<int> & dConst = d;
+      dConst.for_each_segment([&](const int * p, size_t num)
+      {
+         runs.push_back(num);
+         for (size_t i = 0; i < num; i++)
+            values.push_back(p[i]);
+      });
+      // verify
+      //   [-20 ... -17] [-16 ... -1] | [0 ... 15] [16 ... 19]
+      assertUnit(runs == std::vector<size_t>({ 4, 16, 16, 4 }));
+      assertUnit(values.size() == 40);
+      for (int i = 0; i < 40; i++)
+         assertUnit(values[i] == i - 20);
+      int id = 0;
+      for (auto it = d.begin(); it != d.end(); ++it, ++id)
+         assertUnit(*it == id - 20);
+      assertUnit(id == 40);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // popping frees blocks left behind, but keeps the next one out
+   void test_popBack_keepsOneSpare()
+   {  // setup
+      custom::geometric_deque<Spy> d;
+      for (int i = 0; i < 200; i++)
+         d.push_back(Spy(i));
+      assertUnit(d.blocks[0][3] != nullptr);
+      Spy::reset();
+      // exercise
+      while (d.size() > 20)
+         d.pop_back();
+      // verify
+      //   blocks 0 and 1 in use, block 2 spare, block 3 freed
+      assertUnit(Spy::numDestructor() == 180);
+      assertUnit(Spy::numDelete() == 180);
+      assertUnit(d.blocks[0][2] != nullptr);
+      assertUnit(d.blocks[0][3] == nullptr);
+      assertUnit(d.back() == Spy(19));
+      // exercise
+      d.push_back(Spy(20));
+      d.push_back(Spy(21));
+      // verify
+      assertUnit(d.size() == 22);
+      assertUnit(d.back() == Spy(21));
+   }  // teardown
+
+   // a drained queue frees its blocks and goes back to the origin
+   void test_popFront_emptyStartsOver()
+   {  // setup
+      custom::geometric_deque<Spy> d;
+      for (int i = 0; i < 1000; i++)
+         d.push_back(Spy(i));
+      Spy::reset();
+      // exercise
+      for (int i = 0; i < 1000; i++)
+      {
+         assertUnit(d.front().get() == i);
+         d.pop_front();
+      }
+      // verify
+      assertUnit(Spy::numDestructor() == 1000);
+      assertUnit(d.empty());
+      assertUnit(d.posFront == 0);
+      for (int ib = 0; ib < custom::geometric_deque<Spy>::NUM_BLOCKS_MAX; ib++)
+         assertUnit(d.blocks[0][ib] == nullptr);
+      // exercise
+      d.push_back(Spy(7));
+      // verify
+      assertUnit(&d.front() == d.blocks[0][0]);
+   }  // teardown
+
+   void test_clear_standard()
+   {  // setup
+      custom::geometric_deque<Spy> d;
+      for (int i = 0; i < 100; i++)
+      {
+         d.push_back(Spy(i));
+         d.push_front(Spy(-i));
+      }
+      Spy::reset();
+      // exercise
+      d.clear();
+      // verify
+      assertUnit(Spy::numDestructor() == 200);
+      assertUnit(Spy::numDelete() == 200);
+      assertUnit(d.empty());
+      assertUnit(d.posFront == 0);
+      assertUnit(d.blocks[0][1] == nullptr);
+      assertUnit(d.blocks[1][1] == nullptr);
+   }  // teardown
+
+   /***************************************
+    * COPY
+    ***************************************/
+
+   void test_copy_standard()
+   {  // setup
+      custom::geometric_deque<Spy> d;
+      for (int i = 0; i < 30; i++)
+      {
+         d.push_back(Spy(i));
+         d.push_front(Spy(-i));
+      }
+      Spy::reset();
+      // exercise
+      custom::geometric_deque<Spy> dCopy(d);
+      // verify
+      assertUnit(Spy::numCopy() == 60);
+      assertUnit(dCopy.size() == 60);
+      for (size_t id = 0; id < 60; id++)
+         assertUnit(dCopy[id] == d[id]);
+   }  // teardown
+
+   void test_move_standard()
+   {  // setup
+      custom::geometric_deque<Spy> d;
+      for (int i = 0; i < 30; i++)
+         d.push_front(Spy(i));
+      Spy::reset();
+      // exercise
+      custom::geometric_deque<Spy> dMove(std::move(d));
+      // verify
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(dMove.size() == 30);
+      assertUnit(dMove.front() == Spy(29));
+      assertUnit(d.empty());
+      // exercise
+      d = std::move(dMove);
+      // verify
+      assertUnit(d.size() == 30);
+      assertUnit(d.back() == Spy(0));
+   }  // teardown
+};
+
+#endif // DEBUG
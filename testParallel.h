@@ -0,0 +1,295 @@
+/***********************************************************************
+ * Header:
+ *    TEST PARALLEL
+ * Summary:
+ *    Unit tests for the deque's multithreaded copy and clear
+ * Author
+ *    Marco Varela & Andre Regino
+ ************************************************************************/
+
+#pragma once
+#ifdef DEBUG
+
+#include "parallel.h"   // class under test
+#include "unitTest.h"   // unit test baseclass
+#include <atomic>       // for std::atomic
+#include <climits>      // for INT_MIN
+#include <stdexcept>    // for std::runtime_error
+#include <vector>       // for std::vector
+
+/***********************************************
+ * TALLY
+ * An element that counts the live copies of itself.
+ * Unlike Spy, safe to copy on several threads at once
+ ***********************************************/
+class Tally
+{
+public:
+   Tally(int value = 0) : value(value) { ++numLive(); }
+   Tally(const Tally & rhs) : value(rhs.value)
+   {
+      if (value == throwOn())
+         throw std::runtime_error("Tally");
+      ++numLive();
+   }
+   ~Tally() { --numLive(); }
+   Tally & operator = (const Tally & rhs) { value = rhs.value; return *this; }
+   bool operator == (const Tally & rhs) const { return value == rhs.value; }
+
+   static std::atomic<int> & numLive() { static std::atomic<int> num(0); return num; }
+   static std::atomic<int> & throwOn() { static std::atomic<int> value(INT_MIN); return value; }
+
+   int value;
+};
+
+/***********************************************
+ * TEST PARALLEL
+ * Unit tests for the deque's multithreaded copy and clear
+ ***********************************************/
+class TestParallel : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Pool
+      test_pool_everyTask();
+      test_pool_single();
+
+      // Copy
+      test_copy_empty();
+      test_copy_wrapped();
+      test_copy_nonTrivial();
+      test_copy_chunked();
+      test_copy_throws();
+
+      // Clear
+      test_clear_empty();
+      test_clear_trivial();
+      test_clear_nonTrivial();
+      test_clear_wrappedInBlock();
+
+      report("Parallel");
+   }
+
+   /***************************************
+    * POOL
+    ***************************************/
+
+   // every task runs exactly once, run after run
+   void test_pool_everyTask()
+   {  // setup
+      custom::deque_thread_pool pool(4);
+      std::vector<std::atomic<int>> numRuns(1000);
+      for (auto & num : numRuns)
+         num = 0;
+      // exercise
+      pool.run(1000, [&](size_t iTask) { ++numRuns[iTask]; });
+      pool.run(500, [&](size_t iTask) { ++numRuns[iTask]; });
+      // verify
+      assertUnit(pool.size() == 4);
+      for (size_t i = 0; i < 1000; i++)
+         assertUnit(numRuns[i] == (i < 500 ? 2 : 1));
+   }  // teardown
+
+   // a pool of one is just the caller
+   void test_pool_single()
+   {  // setup
+      custom::deque_thread_pool pool(1);
+      int sum = 0;
+      // exercise
+      pool.run(10, [&](size_t iTask) { sum += static_cast<int>(iTask); });
+      // verify
+      assertUnit(pool.size() == 1);
+      assertUnit(sum == 45);
+   }  // teardown
+
+   /***************************************
+    * COPY
+    ***************************************/
+
+   void test_copy_empty()
+   {  // setup
+      custom::deque<int> d;
+      // exercise
+      custom::deque<int> dCopy = custom::parallel_copy(d, 4);
+      // verify
+      assertUnit(dCopy.empty());
+      assertUnit(dCopy.data == nullptr);
+   }  // teardown
+
+   // the copy keeps the source's front cell, in blocks that do not wrap
+   void test_copy_wrapped()
+   {  // setup
+      custom::deque<int> d;
+      for (int i = 0; i < 5000; i++)
+      {
+         d.push_back(i);
+         d.push_front(-i);
+      }
+      // exercise
+      custom::deque<int> dCopy = custom::parallel_copy(d, 4);
+      // verify
+      assertUnit(dCopy.size() == 10000);
+      assertUnit(dCopy.iaFront == d.iaFront % 16);
+      assertUnit(dCopy.numBlocks == static_cast<size_t>(dCopy.iaFront + 10000 + 15) / 16);
+      for (int id = 0; id < 10000; id++)
+         assertUnit(dCopy[id] == d[id]);
+      // exercise
+      dCopy.push_back(5000);
+      dCopy.push_front(-5000);
+      // verify
+      assertUnit(dCopy.front() == -5000);
+      assertUnit(dCopy.back() == 5000);
+   }  // teardown
+
+   void test_copy_nonTrivial()
+   {  // setup
+      Tally::numLive() = 0;
+      {
+         custom::deque<Tally> d;
+         for (int i = 0; i < 3000; i++)
+            d.push_front(Tally(i));
+         assertUnit(Tally::numLive() == 3000);
+         // exercise
+         custom::deque<Tally> dCopy = custom::parallel_copy(d, 3);
+         // verify
+         assertUnit(Tally::numLive() == 6000);
+         assertUnit(dCopy.size() == 3000);
+         for (int id = 0; id < 3000; id++)
+            assertUnit(dCopy[id].value == 2999 - id);
+      }
+      assertUnit(Tally::numLive() == 0);
+   }  // teardown
+
+   void test_copy_chunked()
+   {  // setup
+      custom::deque<int, std::allocator<int>, custom::with_map<custom::map_chunked<4>>> d;
+      for (int i = 0; i < 1000; i++)
+         d.push_back(i);
+      custom::deque_thread_pool pool(2);
+      // exercise
+      auto dCopy = custom::parallel_copy(d, pool);
+      // verify
+      assertUnit(dCopy.size() == 1000);
+      for (int id = 0; id < 1000; id++)
+         assertUnit(dCopy[id] == id);
+   }  // teardown
+
+   // a copy that throws partway leaves nothing behind
+   void test_copy_throws()
+   {  // setup
+      Tally::numLive() = 0;
+      {
+         custom::deque<Tally> d;
+         for (int i = 0; i < 4000; i++)
+            d.push_back(Tally(i));
+         Tally::throwOn() = 2500;
+         // exercise
+         bool thrown = false;
+         try
+         {
+            custom::deque<Tally> dCopy = custom::parallel_copy(d, 4);
+         }
+         catch (const std::runtime_error &)
+         {
+            thrown = true;
+         }
+         Tally::throwOn() = INT_MIN;
+         // verify
+         assertUnit(thrown);
+         assertUnit(Tally::numLive() == 4000);
+      }
+      assertUnit(Tally::numLive() == 0);
+   }  // teardown
+
+   /***************************************
+    * CLEAR
+    ***************************************/
+
+   void test_clear_empty()
+   {  // setup
+      custom::deque<Tally> d;
+      // exercise
+      custom::parallel_clear(d, 4);
+      // verify
+      assertUnit(d.empty());
+      assertUnit(d.data == nullptr);
+   }  // teardown
+
+   // nothing to destroy, so just the blocks go
+   void test_clear_trivial()
+   {  // setup
+      custom::deque<int> d;
+      for (int i = 0; i < 1000; i++)
+         d.push_back(i);
+      // exercise
+      custom::parallel_clear(d, 4);
+      // verify
+      assertUnit(d.empty());
+      for (size_t ib = 0; ib < d.numBlocks; ib++)
+         assertUnit(d.data[static_cast<int>(ib)] == nullptr);
+   }  // teardown
+
+   void test_clear_nonTrivial()
+   {  // setup
+      Tally::numLive() = 0;
+      {
+         custom::deque<Tally> d;
+         for (int i = 0; i < 3000; i++)
+         {
+            d.push_back(Tally(i));
+            d.push_front(Tally(-i));
+         }
+         assertUnit(Tally::numLive() == 6000);
+         custom::deque_thread_pool pool(3);
+         // exercise
+         custom::parallel_clear(d, pool);
+         // verify
+         assertUnit(Tally::numLive() == 0);
+         assertUnit(d.empty());
+         for (size_t ib = 0; ib < d.numBlocks; ib++)
+            assertUnit(d.data[static_cast<int>(ib)] == nullptr);
+         // exercise
+         d.push_back(Tally(7));
+         // verify
+         assertUnit(d.front().value == 7);
+      }
+      assertUnit(Tally::numLive() == 0);
+   }  // teardown
+
+   // the back has wrapped around into the front's block
+   void test_clear_wrappedInBlock()
+   {  // setup
+      //             iaFront
+      //   +----+----+----+----+   +----+----+----+----+
+      //   | 6  |    | 0  | 1  |   | 2  | 3  | 4  | 5  |
+      //   +----+----+----+----+   +----+----+----+----+
+      Tally::numLive() = 0;
+      {
+         custom::deque<Tally> d;
+         d.numCells = 4;
+         d.numElements = 7;
+         d.numBlocks = 2;
+         d.data = new Tally * [2];
+         d.data[0] = d.alloc.allocate(d.numCells);
+         d.data[1] = d.alloc.allocate(d.numCells);
+         d.iaFront = 2;
+         for (int id = 0; id < 7; id++)
+            new (&d[id]) Tally(id);
+         assertUnit(&d[6] == d.data[0]);
+         assertUnit(Tally::numLive() == 7);
+         // exercise
+         custom::parallel_clear(d, 2);
+         // verify
+         assertUnit(Tally::numLive() == 0);
+         assertUnit(d.empty());
+         assertUnit(d.data[0] == nullptr);
+         assertUnit(d.data[1] == nullptr);
+      }
+      assertUnit(Tally::numLive() == 0);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,254 @@
+/***********************************************************************
+ * Header:
+ *    TEST QUEUE
+ * Summary:
+ *    Unit tests for the queue adapter
+ * Author
+ *    Marco Varela & Andre Regino
+ ************************************************************************/
+
+#pragma once
+#ifdef DEBUG
+
+#include "queue.h"      // class under test
+#include "spy.h"        // for the Spy class
+#include "unitTest.h"   // unit test baseclass
+#include <vector>       // for std::vector
+
+/***********************************************
+ * TEST QUEUE
+ * Unit tests for the queue adapter
+ ***********************************************/
+class TestQueue : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Insert
+      test_push_withinBlock();
+      test_push_fullMap();
+      test_pushrange_sharedBlock();
+
+      // Remove
+      test_pop_withinBlock();
+      test_pop_lastInBlock();
+      test_pop_sharedBlock();
+      test_popinto_frontFirst();
+
+      // Status
+      test_reserve();
+      test_segments();
+
+      report("Queue");
+   }
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // pushing into the back block only bumps the cursor
+   void test_push_withinBlock()
+   {  // setup
+      custom::queue<Spy> q;
+      q.container.numCells = 4;
+      q.push(Spy(10));
+      Spy* pBlock = q.container.data[0];
+      Spy::reset();
+      // exercise
+      q.push(Spy(11));
+      q.push(Spy(12));
+      // verify
+      assertUnit(Spy::numCopyMove() == 2);
+      assertUnit(Spy::numAlloc() == 2);
+      assertUnit(q.size() == 3);
+      assertUnit(q.front() == Spy(10));
+      assertUnit(q.back() == Spy(12));
+      assertUnit(q.pBack == pBlock + 3);
+      assertUnit(q.container[2] == Spy(12));
+   }  // teardown
+
+   // pushing after the map fills moves to a bigger map
+   void test_push_fullMap()
+   {  // setup
+      //    [  ,   , 2, 3][4, 5, 6, 7]
+      custom::queue<int> q;
+      q.container.numCells = 4;
+      for (int i = 0; i < 8; i++)
+         q.push(i);
+      q.pop();
+      q.pop();
+      // exercise
+      for (int i = 8; i < 12; i++)
+         q.push(i);
+      // verify
+      //    [  ,   , 2, 3][4, 5, 6, 7][8, 9, 10, 11][  ,  ,  ,  ]
+      assertUnit(q.container.numBlocks == 4);
+      assertUnit(q.size() == 10);
+      for (int i = 0; i < 10; i++)
+         assertUnit(q.container[i] == i + 2);
+      assertUnit(q.front() == 2);
+      assertUnit(q.back() == 11);
+      assertUnit(q.pBack == q.pBackEnd);
+   }  // teardown
+
+   // a forward range fills the back block a run at a time
+   void test_pushrange_sharedBlock()
+   {  // setup
+      custom::queue<int> q;
+      q.container.numCells = 4;
+      q.push(-1);
+      std::vector<int> v;
+      for (int i = 0; i < 9; i++)
+         v.push_back(i);
+      // exercise
+      q.push_range(v.begin(), v.end());
+      // verify
+      assertUnit(q.size() == 10);
+      assertUnit(q.back() == 8);
+      assertUnit(q.pFrontEnd == q.pFront + 4);
+      // exercise
+      for (int i = -1; i < 9; i++)
+      {
+         // verify
+         assertUnit(q.front() == i);
+         q.pop();
+      }
+      assertUnit(q.empty());
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // popping inside the front block only moves the cursor
+   void test_pop_withinBlock()
+   {  // setup
+      custom::queue<Spy> q;
+      q.container.numCells = 4;
+      for (int i = 0; i < 6; i++)
+         q.push(Spy(i));
+      Spy::reset();
+      // exercise
+      q.pop();
+      // verify
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(Spy::numDelete() == 1);
+      assertUnit(q.size() == 5);
+      assertUnit(q.front() == Spy(1));
+      assertUnit(q.container.iaFront == 1);
+      assertUnit(q.container.front() == Spy(1));
+   }  // teardown
+
+   // a small queue whose ends share a block pops on the fast path,
+   // leaving the deque only when the front crosses into a new block
+   void test_pop_sharedBlock()
+   {  // setup
+      custom::queue<int> q;
+      for (int i = 0; i < 4; i++)
+         q.push(i);
+      int numSlow = 0;
+      // exercise
+      for (int i = 4; i < 1004; i++)
+      {
+         q.push(i);
+         if (!(q.pFront + 1 < q.pFrontEnd))
+            numSlow++;
+         q.pop();
+         // verify
+         assertUnit(q.front() == i - 3);
+      }
+      // verify
+      assertUnit(numSlow <= 1000 / 16 + 1);
+      assertUnit(q.size() == 4);
+      assertUnit(q.back() == 1003);
+   }  // teardown
+
+   // popping the last element of a block frees the block
+   void test_pop_lastInBlock()
+   {  // setup
+      custom::queue<Spy> q;
+      q.container.numCells = 4;
+      for (int i = 0; i < 6; i++)
+         q.push(Spy(i));
+      for (int i = 0; i < 3; i++)
+         q.pop();
+      Spy::reset();
+      // exercise
+      q.pop();
+      // verify
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(q.size() == 2);
+      assertUnit(q.front() == Spy(4));
+      assertUnit(q.container.data[0] == nullptr);
+      assertUnit(q.pFront == q.container.data[1]);
+   }  // teardown
+
+   // batch pop hands out the front first
+   void test_popinto_frontFirst()
+   {  // setup
+      custom::queue<int> q;
+      q.container.numCells = 4;
+      for (int i = 0; i < 10; i++)
+         q.push(i);
+      int out[6] = {};
+      // exercise
+      size_t num = q.pop_into(out, 6);
+      // verify
+      assertUnit(num == 6);
+      for (int i = 0; i < 6; i++)
+         assertUnit(out[i] == i);
+      assertUnit(q.size() == 4);
+      assertUnit(q.front() == 6);
+      assertUnit(q.back() == 9);
+      q.pop();
+      assertUnit(q.front() == 7);
+   }  // teardown
+
+   /***************************************
+    * STATUS
+    ***************************************/
+
+   // reserve sizes the map so pushing never reallocates
+   void test_reserve()
+   {  // setup
+      custom::queue<int> q;
+      q.container.numCells = 4;
+      // exercise
+      q.reserve(100);
+      int** data = q.container.data;
+      for (int i = 0; i < 100; i++)
+         q.push(i);
+      // verify
+      assertUnit(q.container.data == data);
+      assertUnit(q.container.numBlocks == 25);
+      assertUnit(q.front() == 0);
+      assertUnit(q.back() == 99);
+   }  // teardown
+
+   // segments cover the queue front to back
+   void test_segments()
+   {  // setup
+      custom::queue<int> q;
+      q.container.numCells = 4;
+      for (int i = 0; i < 10; i++)
+         q.push(i);
+      q.pop();
+      int numSegments = 0;
+      int next = 1;
+      // exercise
+      q.for_each_segment([&](const int * p, size_t num)
+      {
+         numSegments++;
+         for (size_t i = 0; i < num; i++)
+            if (p[i] == next)
+               next++;
+      });
+      // verify
+      assertUnit(numSegments == 3);
+      assertUnit(next == 10);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,200 @@
+/***********************************************************************
+ * Header:
+ *    TEST RECLAIMER
+ * Summary:
+ *    Unit tests for the deque reclaimer
+ * Author
+ *    Marco Varela & Andre Regino
+ ************************************************************************/
+
+#pragma once
+#ifdef DEBUG
+
+#include "reclaimer.h"  // class under test
+#include "spy.h"        // for the Spy class
+#include "unitTest.h"   // unit test baseclass
+
+/***********************************************
+ * TEST RECLAIMER
+ * Unit tests for the deque reclaimer
+ ***********************************************/
+class TestReclaimer : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Retire
+      test_retire_destroysNothing();
+      test_retire_empty();
+
+      // Reclaim
+      test_collect_all();
+      test_collect_budget();
+      test_collect_wide();
+      test_start_background();
+      test_destructor_collects();
+
+      report("Reclaimer");
+   }
+
+   /***************************************
+    * RETIRE
+    ***************************************/
+
+   // retiring hands the elements over without touching them
+   void test_retire_destroysNothing()
+   {  // setup
+      custom::deque_reclaimer<Spy> r;
+      custom::deque<Spy> d;
+      for (int i = 0; i < 100; i++)
+         d.push_back(Spy(i));
+      Spy::reset();
+      // exercise
+      r.retire(d);
+      // verify
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(r.pending() == 1);
+      assertUnit(d.empty());
+      // the retired deque's owner may keep using it
+      d.push_back(Spy(7));
+      assertUnit(d.size() == 1);
+      assertUnit(d.front() == Spy(7));
+   }  // teardown
+
+   // a deque that never allocated has nothing to reclaim
+   void test_retire_empty()
+   {  // setup
+      custom::deque_reclaimer<Spy> r;
+      custom::deque<Spy> d;
+      // exercise
+      r.retire(d);
+      // verify
+      assertUnit(r.pending() == 0);
+      assertUnit(d.empty());
+   }  // teardown
+
+   /***************************************
+    * RECLAIM
+    ***************************************/
+
+   // collect with no budget destroys everything retired
+   void test_collect_all()
+   {  // setup
+      custom::deque_reclaimer<Spy> r;
+      custom::deque<Spy> d1;
+      custom::deque<Spy> d2;
+      for (int i = 0; i < 100; i++)
+         d1.push_back(Spy(i));
+      for (int i = 0; i < 20; i++)
+         d2.push_front(Spy(i));
+      r.retire(d1);
+      r.retire(d2);
+      Spy::reset();
+      // exercise
+      size_t numFreed = r.collect();
+      // verify
+      assertUnit(Spy::numDestructor() == 120);
+      assertUnit(Spy::numDelete() == 120);
+      assertUnit(numFreed >= 9);
+      assertUnit(r.pending() == 0);
+   }  // teardown
+
+   // a budget cuts a big deque from the back over several calls
+   void test_collect_budget()
+   {  // setup
+      custom::deque_reclaimer<Spy> r;
+      custom::deque<Spy> d;
+      for (int i = 0; i < 100; i++)
+         d.push_back(Spy(i));
+      r.retire(d);
+      Spy::reset();
+      // exercise
+      size_t numFreed = r.collect(2);
+      // verify
+      //   the back block's 4 elements, then one full block
+      assertUnit(numFreed == 2);
+      assertUnit(Spy::numDestructor() == 20);
+      assertUnit(r.pending() == 1);
+      // exercise
+      r.collect();
+      // verify
+      assertUnit(Spy::numDestructor() == 100);
+      assertUnit(r.pending() == 0);
+   }  // teardown
+
+   // a few elements in many spare blocks: the spares go first,
+   // within the budget, and nothing is destroyed until the rest fits
+   void test_collect_wide()
+   {  // setup
+      typedef custom::with_stats<custom::low_latency> Policy;
+      custom::deque_reclaimer<Spy, std::allocator<Spy>, Policy> r;
+      custom::deque<Spy, std::allocator<Spy>, Policy> d;
+      for (int i = 0; i < 2000; i++)
+         d.push_back(Spy(i));
+      for (int i = 0; i < 1995; i++)
+         d.pop_front();
+      size_t numBlocksHeld = d.statistics().numBlockAllocations;
+      assertUnit(d.statistics().numBlockFrees == 0);
+      assertUnit(numBlocksHeld > 4);
+      r.retire(d);
+      Spy::reset();
+      // exercise
+      size_t numFreed = r.collect(2);
+      // verify
+      assertUnit(numFreed == 2);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(r.pending() == 1);
+      // exercise
+      numFreed += r.collect();
+      // verify
+      assertUnit(numFreed == numBlocksHeld);
+      assertUnit(Spy::numDestructor() == 5);
+      assertUnit(r.pending() == 0);
+   }  // teardown
+
+   // the background thread finishes what was retired before it stops
+   void test_start_background()
+   {  // setup
+      custom::deque_reclaimer<Spy> r;
+      custom::deque<Spy> d[4];
+      for (int id = 0; id < 4; id++)
+         for (int i = 0; i < 50; i++)
+            d[id].push_back(Spy(i));
+      // the thread touches the Spy counters, so nothing else may
+      Spy::reset();
+      r.start();
+      // exercise
+      for (int id = 0; id < 4; id++)
+         r.retire(d[id]);
+      r.stop();
+      // verify
+      assertUnit(Spy::numDestructor() == 200);
+      assertUnit(r.pending() == 0);
+      for (int id = 0; id < 4; id++)
+         assertUnit(d[id].empty());
+   }  // teardown
+
+   // going out of scope reclaims what is left
+   void test_destructor_collects()
+   {  // setup
+      custom::deque<Spy> d;
+      for (int i = 0; i < 40; i++)
+         d.push_back(Spy(i));
+      Spy::reset();
+      {
+         custom::deque_reclaimer<Spy> r;
+         r.retire(d);
+         assertUnit(Spy::numDestructor() == 0);
+         // exercise
+      }
+      // verify
+      assertUnit(Spy::numDestructor() == 40);
+   }  // teardown
+};
+
+#endif // DEBUG
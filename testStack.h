@@ -0,0 +1,251 @@
+/***********************************************************************
+ * Header:
+ *    TEST STACK
+ * Summary:
+ *    Unit tests for the stack adapter
+ * Author
+ *    Marco Varela & Andre Regino
+ ************************************************************************/
+
+#pragma once
+#ifdef DEBUG
+
+#include "stack.h"      // class under test
+#include "spy.h"        // for the Spy class
+#include "unitTest.h"   // unit test baseclass
+#include <vector>       // for std::vector
+
+/***********************************************
+ * TEST STACK
+ * Unit tests for the stack adapter
+ ***********************************************/
+class TestStack : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Insert
+      test_push_withinBlock();
+      test_push_newBlock();
+      test_pushrange_acrossBlocks();
+
+      // Remove
+      test_pop_withinBlock();
+      test_pop_lastInBlock();
+      test_popinto_topFirst();
+      test_popinto_acrossBlocks();
+
+      // Status
+      test_reserve();
+      test_segments();
+
+      report("Stack");
+   }
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // pushing into the top block only bumps the cursor
+   void test_push_withinBlock()
+   {  // setup
+      custom::stack<Spy> s;
+      s.container.numCells = 4;
+      s.push(Spy(10));
+      Spy* pBlock = s.container.data[0];
+      Spy::reset();
+      // exercise
+      s.push(Spy(11));
+      s.push(Spy(12));
+      // verify
+      assertUnit(Spy::numCopyMove() == 2);
+      assertUnit(Spy::numAlloc() == 2);
+      assertUnit(s.size() == 3);
+      assertUnit(s.top() == Spy(12));
+      assertUnit(s.pBlockBegin == pBlock);
+      assertUnit(s.pNext == pBlock + 3);
+      assertUnit(s.container[0] == Spy(10));
+      assertUnit(s.container[1] == Spy(11));
+      assertUnit(s.container[2] == Spy(12));
+   }  // teardown
+
+   // the deque takes over when the top block is full
+   void test_push_newBlock()
+   {  // setup
+      custom::stack<Spy> s;
+      s.container.numCells = 2;
+      s.push(Spy(10));
+      s.push(Spy(11));
+      Spy::reset();
+      // exercise
+      s.push(Spy(12));
+      // verify
+      assertUnit(Spy::numCopyMove() == 1);
+      assertUnit(s.size() == 3);
+      assertUnit(s.top() == Spy(12));
+      assertUnit(s.container.numBlocks == 2);
+      assertUnit(s.pBlockBegin == s.container.data[1]);
+      assertUnit(s.pNext == s.container.data[1] + 1);
+      assertUnit(s.pBlockEnd == s.container.data[1] + 2);
+   }  // teardown
+
+   // a forward range fills the top block a run at a time
+   void test_pushrange_acrossBlocks()
+   {  // setup
+      custom::stack<int> s;
+      s.container.numCells = 4;
+      s.push(-1);
+      std::vector<int> v;
+      for (int i = 0; i < 9; i++)
+         v.push_back(i);
+      // exercise
+      s.push_range(v.begin(), v.end());
+      // verify
+      assertUnit(s.size() == 10);
+      assertUnit(s.container[0] == -1);
+      for (int i = 0; i < 9; i++)
+         assertUnit(s.container[i + 1] == i);
+      assertUnit(s.top() == 8);
+      assertUnit(s.pNext == s.container.data[2] + 2);
+      // exercise
+      s.push(9);
+      // verify
+      assertUnit(s.top() == 9);
+      assertUnit(s.size() == 11);
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // popping inside the top block leaves the block alone
+   void test_pop_withinBlock()
+   {  // setup
+      custom::stack<Spy> s;
+      s.container.numCells = 4;
+      for (int i = 0; i < 3; i++)
+         s.push(Spy(i));
+      Spy::reset();
+      // exercise
+      s.pop();
+      // verify
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(Spy::numDelete() == 1);
+      assertUnit(s.size() == 2);
+      assertUnit(s.top() == Spy(1));
+      assertUnit(s.container.back() == Spy(1));
+   }  // teardown
+
+   // popping the last element of a block frees the block
+   void test_pop_lastInBlock()
+   {  // setup
+      custom::stack<Spy> s;
+      s.container.numCells = 4;
+      for (int i = 0; i < 5; i++)
+         s.push(Spy(i));
+      Spy::reset();
+      // exercise
+      s.pop();
+      // verify
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(s.size() == 4);
+      assertUnit(s.top() == Spy(3));
+      assertUnit(s.container.data[1] == nullptr);
+      assertUnit(s.pBlockBegin == s.container.data[0]);
+      assertUnit(s.pNext == s.pBlockEnd);
+   }  // teardown
+
+   // batch pop hands out the top first
+   void test_popinto_topFirst()
+   {  // setup
+      custom::stack<int> s;
+      s.container.numCells = 4;
+      for (int i = 0; i < 10; i++)
+         s.push(i);
+      int out[4] = {};
+      // exercise
+      size_t num = s.pop_into(out, 4);
+      // verify
+      assertUnit(num == 4);
+      assertUnit(out[0] == 9);
+      assertUnit(out[1] == 8);
+      assertUnit(out[2] == 7);
+      assertUnit(out[3] == 6);
+      assertUnit(s.size() == 6);
+      assertUnit(s.top() == 5);
+   }  // teardown
+
+   // a whole segment of the top comes off at once, freeing emptied blocks
+   void test_popinto_acrossBlocks()
+   {  // setup
+      custom::stack<Spy> s;
+      s.container.numCells = 4;
+      for (int i = 0; i < 10; i++)
+         s.push(Spy(i));
+      Spy out[7];
+      Spy::reset();
+      // exercise
+      size_t num = s.pop_into(out, 7);
+      // verify
+      assertUnit(num == 7);
+      assertUnit(Spy::numAssignMove() == 7);
+      assertUnit(Spy::numDestructor() == 7);
+      assertUnit(Spy::numCopy() == 0);
+      for (int i = 0; i < 7; i++)
+         assertUnit(out[i] == Spy(9 - i));
+      assertUnit(s.size() == 3);
+      assertUnit(s.top() == Spy(2));
+      assertUnit(s.container.data[1] == nullptr);
+      assertUnit(s.pNext == s.container.data[0] + 3);
+      // exercise
+      s.push(Spy(99));
+      // verify
+      assertUnit(s.top() == Spy(99));
+   }  // teardown
+
+   /***************************************
+    * STATUS
+    ***************************************/
+
+   // reserve sizes the map so pushing never reallocates
+   void test_reserve()
+   {  // setup
+      custom::stack<int> s;
+      s.container.numCells = 4;
+      // exercise
+      s.reserve(100);
+      int** data = s.container.data;
+      for (int i = 0; i < 100; i++)
+         s.push(i);
+      // verify
+      assertUnit(s.container.data == data);
+      assertUnit(s.container.numBlocks == 25);
+      assertUnit(s.top() == 99);
+   }  // teardown
+
+   // segments cover the stack bottom to top
+   void test_segments()
+   {  // setup
+      custom::stack<int> s;
+      s.container.numCells = 4;
+      for (int i = 0; i < 10; i++)
+         s.push(i);
+      int numSegments = 0;
+      int next = 0;
+      // exercise
+      s.for_each_segment([&](const int * p, size_t num)
+      {
+         numSegments++;
+         for (size_t i = 0; i < num; i++)
+            if (p[i] == next)
+               next++;
+      });
+      // verify
+      assertUnit(numSegments == 3);
+      assertUnit(next == 10);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -24,26 +24,78 @@
 #define assertEmptyFixture(x)     assertEmptyFixtureParameters(   x, __LINE__, __FUNCTION__)
 
 #include <iostream>  // for std::cerr
-#include <string>    // for std::string
 #include <vector>    // for std::vector
-#include <map>       // for std::map
+#include <algorithm> // for std::sort
+#include <cstring>   // for std::strcmp
 
 
 class UnitTest
 {
 public:
-   UnitTest() { reset(); }
-   
+   UnitTest() : failures(MAX_FAILURES)
+   {
+      tests.reserve(MAX_TESTS);
+      reset();
+   }
+
 private:
-   // a test failure is a failure string and a line number
+   enum { MAX_TESTS = 256, MAX_FAILURES = 4096 };
+
+   // a test failure is a failure string and a line number. The strings
+   // are the literals from the assert macros so nothing is copied
    struct Failure
    {
-      std::string failure;
+      const char* failure;
       int         lineNumber;
+      int         iTest;       // which test in the tests list
+   };
+
+   // each test is its interned name (__FUNCTION__) and its tallies
+   struct Test
+   {
+      const char* name;
+      int         numAsserts;
+      int         numFailures;
    };
 
-   // each test has a name (the key) and the list of failures(value).
-   std::map<std::string, std::vector<Failure>> tests;
+   std::vector<Test>    tests;         // in order of first assertion
+   std::vector<Failure> failures;      // preallocated failure log
+   int numFailuresLogged;              // slots of the failure log in use
+   int numFailuresDropped;             // failures after the log filled
+   int iTestLast;                      // test of the previous assertion
+
+   /*************************************************************
+    * INTERN TEST
+    * Find the test for a function name. Consecutive assertions
+    * almost always come from the same function so that is a
+    * single pointer compare; otherwise search by address, then
+    * by contents in case the literal was not merged
+    *************************************************************/
+   int internTest(const char* func)
+   {
+      if (iTestLast >= 0 && tests[iTestLast].name == func)
+         return iTestLast;
+
+      for (int i = 0; i < (int)tests.size(); i++)
+         if (tests[i].name == func || std::strcmp(tests[i].name, func) == 0)
+            return iTestLast = i;
+
+      tests.push_back(Test{func, 0, 0});
+      return iTestLast = (int)tests.size() - 1;
+   }
+
+   /*************************************************************
+    * RECORD FAILURE
+    * Append to the preallocated log, counting what does not fit
+    *************************************************************/
+   void recordFailure(int iTest, const char* conditionString, int line)
+   {
+      tests[iTest].numFailures++;
+      if (numFailuresLogged < (int)failures.size())
+         failures[numFailuresLogged++] = Failure{conditionString, line, iTest};
+      else
+         numFailuresDropped++;
+   }
 
 protected:
    /*************************************************************
@@ -53,23 +105,37 @@ protected:
    void reset()
    {
       tests.clear();
+      numFailuresLogged = 0;
+      numFailuresDropped = 0;
+      iTestLast = -1;
    }
-   
+
    /*************************************************************
     * REPORT
     * Report the statistics
     *************************************************************/
    void report(const char * name)
-   {    
+   {
+      // list the tests alphabetically
+      std::vector<int> order;
+      for (int i = 0; i < (int)tests.size(); i++)
+         order.push_back(i);
+      std::sort(order.begin(), order.end(), [this](int lhs, int rhs)
+         { return std::strcmp(tests[lhs].name, tests[rhs].name) < 0; });
+
       // enumerate the failures, if there are any
-      for (auto & test : tests)
-         if (!test.second.empty())
+      for (int iTest : order)
+         if (tests[iTest].numFailures != 0)
          {
-            std::cerr << "\t" << test.first << "()\n";
-            for (auto & failure : test.second)
-               std::cerr << "\t\tline:"   << failure.lineNumber
-                         << " condition:" << failure.failure << "\n";
+            std::cerr << "\t" << tests[iTest].name << "()\n";
+            for (int i = 0; i < numFailuresLogged; i++)
+               if (failures[i].iTest == iTest)
+                  std::cerr << "\t\tline:"   << failures[i].lineNumber
+                            << " condition:" << failures[i].failure << "\n";
          }
+      if (numFailuresDropped)
+         std::cerr << "\t(" << numFailuresDropped
+                   << " more failures not listed)\n";
 
       // Name the test case
       std::cerr << name << ":\t";
@@ -84,7 +150,7 @@ protected:
       // determine the success rate
       int numSuccess = 0;
       for (auto& test : tests)
-         numSuccess += (test.second.empty() ? 1 : 0);
+         numSuccess += (test.numFailures == 0 ? 1 : 0);
       double successRate = (double)numSuccess / (double)tests.size();
 
       // display the summary
@@ -96,30 +162,24 @@ protected:
          << (successRate * 100.0) << "%\n";
 
    }
-   
+
    /*************************************************************
     * ASSERT UNIT PARAMETERS
-    * Custom assert code so we can see all the errors at once
+    * Custom assert code so we can see all the errors at once.
+    * A passing assertion costs a compare and an increment
     *************************************************************/
    void assertUnitParameters(bool condition, const char* conditionString,
                              int line, const char* func)
    {
-      std::string sFunc(func);
+      int iTest = internTest(func);
+      tests[iTest].numAsserts++;
 
+      // add a failure to the list of failures
       if (!condition)
-      {
-         // add a failure to the list of failures
-         Failure failure{std::string(conditionString), line};
-         tests[sFunc].push_back(failure);
-      }
-      else
-      {
-         // this ensures there is a placeholder for the successful test
-         tests[sFunc];
-      }
+         recordFailure(iTest, conditionString, line);
    }
-   
-   
+
+
    /*************************************************************
     * ASSERT UNIT PARAMETERS INDIRECT
     * Custom assert code so we can see all the errors at once from
@@ -129,19 +189,11 @@ protected:
                                      int lineOriginal, const char* funcOriginal,
                                      int lineCheck, const char* funcCheck)
    {
-      std::string sFunc(funcOriginal);
-      
+      int iTest = internTest(funcOriginal);
+      tests[iTest].numAsserts++;
+
       if (!condition)
-      {
-         // add a failure to the list of failures
-         Failure failure{std::string(conditionString), lineOriginal};
-         tests[sFunc].push_back(failure);
-      }
-      else
-      {
-         // this ensures there is a placeholder for the successful test
-         tests[sFunc];
-      }
+         recordFailure(iTest, conditionString, lineOriginal);
    }
 };
 